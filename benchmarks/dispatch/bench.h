@@ -0,0 +1,80 @@
+// The measuring part of the dispatch benchmarks generated by converter.sh,
+// shared by the C++ and the C benchmark of a class. Each measurement prints
+// a line "kind<TAB>method<TAB>ns per call<TAB>instructions per call", the
+// instructions are counted by the perf events of linux, and are "-" when
+// they are not available (e.g. in containers).
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+// the methods are not inlined, so each call is measured.
+#define BENCH_NOINLINE __attribute__((noinline))
+
+static volatile int bench_sink;
+static int bench_counter = -1;
+
+static void bench_open_counter(void)
+{
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    bench_counter = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static long long bench_instructions(void)
+{
+    long long count;
+
+    if (bench_counter < 0 || read(bench_counter, &count, sizeof(count)) != sizeof(count))
+        return -1;
+
+    return count;
+}
+
+static double bench_now(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec*1e9 + now.tv_nsec;
+}
+
+static void bench_report(const char *kind, const char *method, long long n,
+                         double elapsed, long long instructions)
+{
+    if (instructions < 0)
+        printf("%s\t%s\t%.2f\t-\n", kind, method, elapsed/n);
+    else
+        printf("%s\t%s\t%.2f\t%.2f\n", kind, method, elapsed/n, (double)instructions/n);
+}
+
+// run statement n times after a warm up, with bench_i as the loop counter.
+#define BENCH(kind, method, n, statement) \
+    do { \
+        long long bench_i, bench_start_instructions, bench_end_instructions; \
+        double bench_start; \
+        for (bench_i = 0; bench_i < (n)/16 + 1; bench_i++) { statement; } \
+        bench_start_instructions = bench_instructions(); \
+        bench_start = bench_now(); \
+        for (bench_i = 0; bench_i < (n); bench_i++) { statement; } \
+        bench_report(kind, method, n, bench_now() - bench_start, \
+                     (bench_end_instructions = bench_instructions()) < 0 ? -1 : \
+                     bench_end_instructions - bench_start_instructions); \
+    } while (0)
+
+#endif
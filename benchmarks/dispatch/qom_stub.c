@@ -0,0 +1,162 @@
+// See qom_stub.h.
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "qom_stub.h"
+
+#define TYPE_MAX 64
+
+struct TypeImpl {
+    const TypeInfo *info;
+    TypeImpl *parent;
+    ObjectClass *class;
+};
+
+static const TypeInfo object_info = {
+    .name = TYPE_OBJECT,
+    .instance_size = sizeof(Object),
+    .abstract = true,
+    .class_size = sizeof(ObjectClass),
+};
+
+static TypeImpl types[TYPE_MAX];
+static unsigned int type_num = 0;
+
+
+TypeImpl *type_register_static(const TypeInfo *info)
+{
+    if (type_num == 0 && info != &object_info)
+        type_register_static(&object_info);
+
+    assert(type_num < TYPE_MAX);
+    types[type_num].info = info;
+    return &types[type_num++];
+}
+
+// qemu looks up a hash table, the types of a benchmark are only a few.
+static TypeImpl *type_get_by_name(const char *name)
+{
+    for (unsigned int i=0; i<type_num; i++)
+        if (strcmp(types[i].info->name, name) == 0)
+            return &types[i];
+
+    return NULL;
+}
+
+static void type_initialize(TypeImpl *type)
+{
+    if (type->class != NULL)
+        return;
+
+    type->class = calloc(1, type->info->class_size);
+    assert(type->class != NULL);
+
+    if (type->info->parent != NULL) {
+        type->parent = type_get_by_name(type->info->parent);
+        assert(type->parent != NULL);
+        type_initialize(type->parent);
+        memcpy(type->class, type->parent->class, type->parent->info->class_size);
+    }
+
+    type->class->type = type;
+    if (type->info->class_init != NULL)
+        type->info->class_init(type->class, NULL);
+}
+
+static void object_init_with_type(Object *obj, TypeImpl *type)
+{
+    if (type->parent != NULL)
+        object_init_with_type(obj, type->parent);
+
+    if (type->info->instance_init != NULL)
+        type->info->instance_init(obj);
+}
+
+static void object_finalize_with_type(Object *obj, TypeImpl *type)
+{
+    for (; type != NULL; type = type->parent)
+        if (type->info->instance_finalize != NULL)
+            type->info->instance_finalize(obj);
+}
+
+void object_initialize(void *data, size_t size, const char *typename)
+{
+    TypeImpl *type = type_get_by_name(typename);
+    Object *obj = data;
+
+    assert(type != NULL);
+    type_initialize(type);
+    assert(size >= type->info->instance_size);
+    assert(!type->info->abstract);
+
+    memset(obj, 0, type->info->instance_size);
+    obj->class = type->class;
+    object_init_with_type(obj, type);
+}
+
+Object *object_new(const char *typename)
+{
+    TypeImpl *type = type_get_by_name(typename);
+    Object *obj;
+
+    assert(type != NULL);
+    type_initialize(type);
+
+    obj = malloc(type->info->instance_size);
+    assert(obj != NULL);
+    object_initialize(obj, type->info->instance_size, typename);
+
+    return obj;
+}
+
+// objects are not reference counted here, they are freed at once.
+void object_unref(Object *obj)
+{
+    object_finalize_with_type(obj, obj->class->type);
+    free(obj);
+}
+
+ObjectClass *object_get_class(Object *obj)
+{
+    return obj->class;
+}
+
+#ifdef CONFIG_QOM_CAST_DEBUG
+static ObjectClass *object_class_dynamic_cast(ObjectClass *oc,
+                                              const char *typename)
+{
+    TypeImpl *target = type_get_by_name(typename);
+
+    for (TypeImpl *type = oc->type; type != NULL; type = type->parent)
+        if (type == target)
+            return oc;
+
+    return NULL;
+}
+#endif
+
+ObjectClass *object_class_dynamic_cast_assert(ObjectClass *oc,
+                                              const char *typename)
+{
+#ifdef CONFIG_QOM_CAST_DEBUG
+    ObjectClass *ret = object_class_dynamic_cast(oc, typename);
+
+    assert(ret != NULL);
+    return ret;
+#else
+    (void)typename;
+    return oc;
+#endif
+}
+
+Object *object_dynamic_cast_assert(Object *obj, const char *typename)
+{
+#ifdef CONFIG_QOM_CAST_DEBUG
+    assert(object_class_dynamic_cast(obj->class, typename) != NULL);
+#else
+    (void)typename;
+#endif
+    return obj;
+}
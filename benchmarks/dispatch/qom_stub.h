@@ -0,0 +1,64 @@
+// A minimal runtime with the interface of the qemu object model used by the
+// converted classes, for the dispatch benchmarks generated by converter.sh.
+// Like in qemu, types are looked up by name, the class of a type is a copy of
+// the class of its parent completed by its class_init, and the casts walk the
+// ancestors of the class only if CONFIG_QOM_CAST_DEBUG is defined.
+
+#ifndef QOM_STUB_H
+#define QOM_STUB_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define TYPE_OBJECT "object"
+
+typedef struct TypeImpl TypeImpl;
+typedef struct ObjectClass ObjectClass;
+typedef struct Object Object;
+
+struct ObjectClass {
+    TypeImpl *type;
+};
+
+struct Object {
+    ObjectClass *class;
+};
+
+typedef struct TypeInfo {
+    const char *name;
+    const char *parent;
+    size_t instance_size;
+    void (*instance_init)(Object *obj);
+    void (*instance_finalize)(Object *obj);
+    bool abstract;
+    size_t class_size;
+    void (*class_init)(ObjectClass *oc, void *data);
+} TypeInfo;
+
+TypeImpl *type_register_static(const TypeInfo *info);
+
+Object *object_new(const char *typename);
+void object_initialize(void *data, size_t size, const char *typename);
+void object_unref(Object *obj);
+
+ObjectClass *object_get_class(Object *obj);
+Object *object_dynamic_cast_assert(Object *obj, const char *typename);
+ObjectClass *object_class_dynamic_cast_assert(ObjectClass *oc,
+                                              const char *typename);
+
+#define OBJECT(obj) \
+        ((Object *)(obj))
+
+#define OBJECT_CLASS(class) \
+        ((ObjectClass *)(class))
+
+#define OBJECT_CHECK(type, obj, name) \
+        ((type *)object_dynamic_cast_assert(OBJECT(obj), (name)))
+
+#define OBJECT_CLASS_CHECK(class_type, class, name) \
+        ((class_type *)object_class_dynamic_cast_assert(OBJECT_CLASS(class), (name)))
+
+#define OBJECT_GET_CLASS(class, obj, name) \
+        OBJECT_CLASS_CHECK(class, object_get_class(OBJECT(obj)), name)
+
+#endif
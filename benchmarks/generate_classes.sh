@@ -0,0 +1,250 @@
+#!/bin/bash
+# This script generates a synthetic corpus of c++ classes for measuring the
+# throughput of converter.sh. The classes are written in the same style as
+# the classes of the OBS framework (see examples/CC_RootObject.*), each class
+# has a header and a source file, and the classes are organized in chains of
+# inheritance.
+
+function usage(){
+   echo "usage: generate_classes.sh [options] output_directory"
+   echo ""
+   echo "options:"
+   echo "  -c N   number of classes, default is 20"
+   echo "  -n N   number of non-virtual methods of each class, default is 20"
+   echo "  -m N   number of virtual methods of each class, default is 4"
+   echo "  -k N   number of static variables of each class, default is 4"
+   echo "  -l N   number of lines of each doc comment, default is 8"
+   echo "  -d N   depth of each inheritance chain, default is 4"
+}
+
+class_num=20
+method_num=20
+virtual_num=4
+static_num=4
+comment_lines=8
+depth=4
+
+while getopts "c:n:m:k:l:d:h" option;
+do
+    case "${option}" in
+        c) class_num=${OPTARG} ;;
+        n) method_num=${OPTARG} ;;
+        m) virtual_num=${OPTARG} ;;
+        k) static_num=${OPTARG} ;;
+        l) comment_lines=${OPTARG} ;;
+        d) depth=${OPTARG} ;;
+        h) usage; exit 0 ;;
+        *) usage; exit 1 ;;
+    esac
+done
+shift $((OPTIND-1))
+
+if [[ $# -lt 1 ]];
+then
+   usage
+   exit 1
+fi
+
+output_dir=$1
+mkdir -p ${output_dir}
+
+
+
+# print a number as a name made of letters (0 is A, 26 is BA), the converter
+# recognizes only the names of methods without digits.
+function letters(){
+    local number=$1
+    local name=''
+    local alphabet=ABCDEFGHIJKLMNOPQRSTUVWXYZ
+    while true;
+    do
+        name=${alphabet:$((number % 26)):1}${name}
+        number=$((number / 26))
+        if [[ ${number} -eq 0 ]];
+        then
+            break
+        fi
+    done
+    echo ${name}
+}
+
+
+# emit a doc comment with the given indentation and number of lines.
+function emit_doc_comment(){
+    echo "$1/**"
+    for ((line=1; line<=$2; line++));
+    do
+        echo "$1* Line ${line} of the description of $3, which is long enough"
+    done
+    echo "$1*/"
+}
+
+
+function emit_header(){
+
+    local self=$1
+    local parent=$2
+    local level=$3
+
+    echo "//"
+    echo "// Copyright 2004 P&P Software GmbH - All Rights Reserved"
+    echo "//"
+    echo "// ${self}.h"
+    echo "//"
+    echo "// Version	1.0"
+    echo "// Date		01.01.04"
+    echo "// Author	generate_classes.sh"
+    echo "//"
+    echo "// Change Record:"
+    echo ""
+    echo "#ifndef ${self}H"
+    echo "#define ${self}H"
+    echo ""
+    echo "#include \"../GeneralInclude/ForwardDeclarations.h\""
+    echo "#include \"../GeneralInclude/BasicTypes.h\""
+    if [[ ${parent} != '' ]];
+    then
+        echo "#include \"${parent}.h\""
+    fi
+    echo ""
+
+    emit_doc_comment "" ${comment_lines} "class ${self}"
+    if [[ ${parent} != '' ]];
+    then
+        echo "class ${self} : public ${parent} {"
+    else
+        echo "class ${self} {"
+    fi
+    echo ""
+
+    echo "  private:"
+    for ((i=0; i<static_num; i++));
+    do
+        echo "    static TD_Integer counter$(letters ${i});"
+    done
+    echo "    TD_Integer value$(letters ${level});"
+    echo "    TD_Integer limit$(letters ${level});"
+    echo ""
+
+    echo "  public:"
+    emit_doc_comment "   " ${comment_lines} "the constructor"
+    echo "    ${self}(void);"
+    echo ""
+
+    # the root of the chain introduces the virtual methods, the others
+    # override them.
+    for ((i=0; i<virtual_num; i++));
+    do
+        emit_doc_comment "   " ${comment_lines} "virtual method check$(letters ${i})"
+        echo "    virtual bool check$(letters ${i})(TD_Integer par);"
+        echo ""
+    done
+
+    for ((i=0; i<method_num; i++));
+    do
+        name=$(letters ${i})
+        emit_doc_comment "   " ${comment_lines} "method ${name}"
+        case $((i % 4)) in
+            0) echo "    TD_Integer getValue${name}(void) const;" ;;
+            1) echo "    void setValue${name}(TD_Integer value);" ;;
+            2) echo "    static TD_Integer getCounter${name}(void);" ;;
+            3) echo "    static void resetCounter${name}(TD_Integer value);" ;;
+        esac
+        echo ""
+    done
+
+    echo "};"
+    echo ""
+    echo "#endif"
+}
+
+
+function emit_source(){
+
+    local self=$1
+    local level=$(letters $3)
+    local counter=counterA
+
+    echo "//"
+    echo "// Copyright 2004 P&P Software GmbH - All Rights Reserved"
+    echo "//"
+    echo "// ${self}.cpp"
+    echo "//"
+    echo "// Version	1.0"
+    echo "// Date		01.01.04"
+    echo "// Author	generate_classes.sh"
+    echo "//"
+    echo "// Change Record:"
+    echo ""
+    echo "#include \"../GeneralInclude/CompilerSwitches.h\""
+    echo "#include \"../GeneralInclude/DebugSupport.h\""
+    echo "#include \"${self}.h\""
+    echo ""
+    for ((i=0; i<static_num; i++));
+    do
+        echo "TD_Integer ${self}::counter$(letters ${i}) = 0;"
+    done
+    echo ""
+
+    echo "${self}::${self}(void) {"
+    echo "  value${level} = 0;"
+    echo "  limit${level} = $3;"
+    echo "}"
+    echo ""
+
+    for ((i=0; i<virtual_num; i++));
+    do
+        echo "bool ${self}::check$(letters ${i})(TD_Integer par) {"
+        echo "  if ( par > limit${level} ) {"
+        echo "     return false;"
+        echo "  }"
+        echo "  return ( value${level} < par );"
+        echo "}"
+        echo ""
+    done
+
+    for ((i=0; i<method_num; i++));
+    do
+        name=$(letters ${i})
+        if [[ ${static_num} -gt 0 ]];
+        then
+            counter=counter$(letters $((i % static_num)))
+        fi
+        case $((i % 4)) in
+            0) echo "TD_Integer ${self}::getValue${name}(void) const {"
+               echo "  return value${level} + ${i};" ;;
+            1) echo "void ${self}::setValue${name}(TD_Integer value) {"
+               echo "  assert( value >= 0 );"
+               echo "  value${level} = value - ${i};" ;;
+            2) echo "TD_Integer ${self}::getCounter${name}(void) {"
+               echo "  return ${counter};" ;;
+            3) echo "void ${self}::resetCounter${name}(TD_Integer value) {"
+               echo "  ${counter} = value;" ;;
+        esac
+        echo "}"
+        echo ""
+    done
+}
+
+
+
+# classes are named Bench_<chain>_<level> with the numbers written in
+# letters, the class at level A is the root of a chain.
+for ((class_index=0; class_index<class_num; class_index++));
+do
+    chain=$((class_index / depth))
+    level=$((class_index % depth))
+
+    self=Bench_$(letters ${chain})_$(letters ${level})
+    parent=''
+    if [[ ${level} -gt 0 ]];
+    then
+        parent=Bench_$(letters ${chain})_$(letters $((level-1)))
+    fi
+
+    # the framework sources have dos line terminators and so have these.
+    emit_header ${self} "${parent}" ${level} | sed 's/$/\r/' > ${output_dir}/${self}.h
+    emit_source ${self} "${parent}" ${level} | sed 's/$/\r/' > ${output_dir}/${self}.cpp
+done
+
+echo "${class_num} classes generated in ${output_dir}"
@@ -0,0 +1,230 @@
+//
+// Copyright 2004 P&P Software GmbH - All Rights Reserved
+//
+// CC_RootObject.c
+//
+// Version	1.0
+// Date		18.04.03 
+// Author	A. Pasetti (P&P Software)
+//
+// Change Record:
+
+#include "../GeneralInclude/CompilerSwitches.h"
+#include "../GeneralInclude/DebugSupport.h"
+#include "../GeneralInclude/ClassId.h"
+#include "../GeneralInclude/Constants.h"
+#include "../Event/DC_EventRepository.h"
+#include "../System/Tracer.h"
+#include "CC_RootObject.h"
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+//                            class  method(s) definition
+//
+///////////////////////////////////////////////////////////////////////////////
+
+bool CC_RootObject_isSystemConfigured(void)
+{
+  for (TD_InstanceId i=0; i<instanceCounter; i++)
+     if ( !pSystemList[i]->isObjectConfigured() )
+        return NOT_CONFIGURED;
+  return CONFIGURED;
+}
+
+void CC_RootObject_setSystemListSize(TD_InstanceId systemListSize)
+{
+  assert(pSystemList == pNULL);
+
+  systemListSize = sysListSize;
+  pSystemList = new CC_RootObject*[systemListSize];
+  for (TD_InstanceId i=0; i<systemListSize; i++)
+        pSystemList[i] = pNULL;
+}
+
+TD_InstanceId CC_RootObject_getSystemListSize(void)
+{
+  return systemListSize;
+}
+
+void CC_RootObject_setEventRepository(DC_EventRepository* pEventRepository)
+{
+  assert( pEventRep != pNULL );
+  pEventRepository = pEventRep;
+}
+
+void CC_RootObject_setParameterDatabase(ParameterDatabase* pDatabase)
+{
+  assert( pDatabase != pNULL );
+  pParameterDatabase = pDatabase;
+}
+
+ParameterDatabase* CC_RootObject_getParameterDatabase(void)
+{
+  assert( pParameterDatabase != pNULL );
+  return pParameterDatabase;
+}
+
+void CC_RootObject_setDataPool(DataPool* pDataPool)
+{
+  assert( pPool != pNULL );
+  pDataPool = pPool;
+}
+
+DataPool* CC_RootObject_getDataPool(void)
+{
+  assert( pDataPool != pNULL );
+  return pDataPool;
+}
+
+void CC_RootObject_setTracer(Tracer* pTracer)
+{
+  assert( pTrace != pNULL );
+  pTracer = pTrace;
+}
+
+Tracer* CC_RootObject_getTracer(void)
+{
+  assert( pTracer != pNULL );
+  return pTracer;
+}
+
+void CC_RootObject_synchTrace(TD_TraceItem traceId)
+{
+   assert( pTracer != pNULL );
+   pTracer->sendSynchTrace(traceId);
+}
+
+void CC_RootObject_packetTrace(unsigned int n, TD_TraceItem traceData[])
+{
+   assert( (pTracer != pNULL) && (traceData != pNULL) );
+   pTracer->sendPacketTrace(n,traceData);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+//                  non-virtual member method(s) definition
+//
+///////////////////////////////////////////////////////////////////////////////
+
+TD_InstanceId CC_RootObject_getInstanceId(const CC_RootObject *This)
+{
+  return instanceId;
+}
+
+TD_ClassId CC_RootObject_getClassId(const CC_RootObject *This)
+{
+  return classId;
+}
+
+void CC_RootObject_setClassId(CC_RootObject *This, TD_ClassId classId)
+{
+  this->classId = classId;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+//                    non-pure virtual  method(s) definition
+//
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Implement the object configuration check service.
+ * The method returns true if the object is correctly configured.
+ * A <CODE>RootObject</CODE> is configured if: <ul>
+ * <li>the event repository has been loaded</li>
+ * <li>the parameter database has been loaded</li>
+ * <li>the data pool has been loaded</li>
+ * <li>the tracer has been loaded</li>
+ * <li>the class identifier has a legal value</li>
+ * </ul>
+ * The configuration check is class-specific and derived classes may have
+ * to provide their own implementation.
+ * Derived classes should however provide only incremental
+ * implementations.
+ * Consider for instance a class B that is derived from a class A.
+ * The implementation of <CODE>isConfigured</CODE> for class B should be
+ * as follows:<PRE>
+ *   bool isConfigured(void) {
+ *   if(!super.isConfigured(void))
+ *           return false;
+ *   . . .  // perform configuration checks specific to class A
+ *   } </PRE>
+ * In this way, each class benefits from the implementation of its super
+ * class.
+ * @return true if the object is configured, false otherwise.
+ */
+static const bool isObjectConfigured(void *obj)
+{
+  return (pEventRepository!=pNULL && pTracer!=pNULL &&
+          pSystemList!=pNULL && pDataPool!=pNULL && pParameterDatabase!=pNULL);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+//                   object constructor and destructor
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// the following may be useful if you don't need it, just delete.
+// CC_RootObject *This = CC_ROOTOBJECT(obj)
+static void instance_init(Object *obj)
+{
+  assert(pSystemList != pNULL);
+  assert(instanceCounter < getSystemListSize());
+
+  instanceId = instanceCounter;
+  setClassId(ID_ROOTOBJECT);
+
+  // register newly created object in the system list.
+  if ( instanceCounter < getSystemListSize() ) {
+     pSystemList[instanceCounter] = this;
+     instanceCounter++;
+  }
+}
+
+CC_RootObject* CC_RootObject_new(void)
+{
+    return (CC_RootObject*)object_new(TYPE_CC_ROOTOBJECT);
+}
+
+void CC_RootObject_init(CC_RootObject *storage)
+{
+    object_initialize(storage, sizeof(CC_RootObject), TYPE_CC_ROOTOBJECT);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+//                   binding and type registration
+//
+///////////////////////////////////////////////////////////////////////////////
+
+static void class_init(ObjectClass *oc, void *data)
+{
+    CC_RootObjectClass *cc_rootobject_class = CC_ROOTOBJECT_CLASS(oc);
+    cc_rootobject_class->isObjectConfigured = isObjectConfigured;
+}
+
+static const TypeInfo type_info = {
+    .name = TYPE_CC_ROOTOBJECT,
+    .parent = TYPE_OBJECT,
+    .instance_size = sizeof(CC_RootObject),
+    .abstract = false,
+    .class_size = sizeof(CC_RootObjectClass),
+    .instance_init = instance_init,
+    .class_init = class_init,
+};
+
+void CC_RootObject_register(void)
+{
+    type_register_static(&type_info);
+}
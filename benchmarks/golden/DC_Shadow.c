@@ -0,0 +1,125 @@
+//
+// DC_Shadow.c
+//
+
+#include "../GeneralInclude/CompilerSwitches.h"
+#include "../GeneralInclude/DebugSupport.h"
+#include "DC_Shadow.h"
+
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+//                            class data
+//
+///////////////////////////////////////////////////////////////////////////////
+
+TD_Integer sharedCounter = 0;
+
+#if defined(__GNUC__)
+#define CLASS_DATA_ALIGNED __attribute__((aligned(64)))
+#else
+#define CLASS_DATA_ALIGNED
+#endif
+
+// the class data are gathered in one struct, so they share cache lines.
+static struct {
+    TD_Integer counterB;
+    TD_Integer counterA;
+} class_data CLASS_DATA_ALIGNED = {
+    .counterB = 0,
+    .counterA = 0,
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+//                            class  method(s) definition
+//
+///////////////////////////////////////////////////////////////////////////////
+
+TD_Integer DC_Shadow_clampA(TD_Integer counterA)
+{
+  return counterA;
+}
+
+TD_Integer DC_Shadow_getCounterA(void)
+{
+  return class_data.counterA;
+}
+
+TD_Integer DC_Shadow_sumB(TD_Integer n)
+{
+  TD_Integer counterB = n; /* not the counterB
+                              of the class */
+  return counterB + class_data.counterA;
+}
+
+TD_Integer DC_Shadow_getCounterB(void)
+{
+  assert( class_data.counterB >= 0 );
+  return class_data.counterB;
+}
+
+TD_Integer DC_Shadow_getSharedCounter(void)
+{
+  return sharedCounter;
+}
+
+void DC_Shadow_setCounterB(TD_Integer value)
+{
+  class_data.counterB = value;
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+//                   object constructor and destructor
+//
+///////////////////////////////////////////////////////////////////////////////
+
+// the following may be useful if you don't need it, just delete.
+// DC_Shadow *This = DC_SHADOW(obj)
+static void instance_init(Object *obj)
+{
+  class_data.counterA++;
+}
+
+DC_Shadow* DC_Shadow_new(void)
+{
+    return (DC_Shadow*)object_new(TYPE_DC_SHADOW);
+}
+
+void DC_Shadow_init(DC_Shadow *storage)
+{
+    object_initialize(storage, sizeof(DC_Shadow), TYPE_DC_SHADOW);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+//                   binding and type registration
+//
+///////////////////////////////////////////////////////////////////////////////
+
+static void class_init(ObjectClass *oc, void *data)
+{
+}
+
+static const TypeInfo type_info = {
+    .name = TYPE_DC_SHADOW,
+    .parent = TYPE_OBJECT,
+    .instance_size = sizeof(DC_Shadow),
+    .abstract = false,
+    .class_size = sizeof(DC_ShadowClass),
+    .instance_init = instance_init,
+    .class_init = class_init,
+};
+
+void DC_Shadow_register(void)
+{
+    type_register_static(&type_info);
+}
@@ -0,0 +1,129 @@
+//
+// DC_Shadow.h
+//
+// regression case of converter.sh: parameters and local variables named
+// like the class data, and a pure getter following a const method whose
+// parameter is named like the class data. the public class data stay
+// globals, and a getter with an assertion is neither pure nor const.
+
+
+#ifndef DC_SHADOW_H
+#define DC_SHADOW_H
+
+
+#include "../GeneralInclude/ForwardDeclarations.h"
+#include "../GeneralInclude/BasicTypes.h"
+#include "../Qom/object.h"
+
+
+/*
+ * Return the parameter, which is named like the class data counterA.
+ */
+#define TYPE_DC_SHADOW "dc_shadow"
+
+void DC_Shadow_register(void);
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+//                            class and struct
+//
+///////////////////////////////////////////////////////////////////////////////
+
+struct DC_Shadow {
+    Object parent;
+};
+
+
+struct DC_ShadowClass {
+    ObjectClass parent_class;
+};
+
+
+#define DC_SHADOW_GET_CLASS(obj) \
+        OBJECT_GET_CLASS(DC_ShadowClass, obj, TYPE_DC_SHADOW)
+
+#define DC_SHADOW_CLASS(klass) \
+        OBJECT_CLASS_CHECK(DC_ShadowClass, klass, TYPE_DC_SHADOW)
+
+#define DC_SHADOW(obj) \
+        OBJECT_CHECK(DC_Shadow, obj, TYPE_DC_SHADOW)
+
+
+DC_Shadow* DC_Shadow_new(void);
+
+// initialize an object in the storage given by the caller, e.g. a member
+// of another struct or a static variable set to DC_SHADOW_INITIALIZER.
+void DC_Shadow_init(DC_Shadow *storage);
+
+#define DC_SHADOW_INITIALIZER { 0 }
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+//                            class method(s) declaration
+//
+///////////////////////////////////////////////////////////////////////////////
+
+TD_Integer DC_Shadow_clampA(TD_Integer counterA);
+
+/**
+ * Return the class data counterA.
+ */
+TD_Integer DC_Shadow_getCounterA(void);
+
+/**
+ * Add the class data counterA to a local variable named counterB.
+ */
+TD_Integer DC_Shadow_sumB(TD_Integer n);
+
+/**
+ * Return the class data counterB, which must not be negative.
+ */
+TD_Integer DC_Shadow_getCounterB(void);
+
+/**
+ * Return the public class data sharedCounter.
+ */
+TD_Integer DC_Shadow_getSharedCounter(void);
+
+/**
+ * Set the class data counterB.
+ */
+void DC_Shadow_setCounterB(TD_Integer value);
+
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+//                        method attribute(s)
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef ATTRIBUTE_PURE
+#if defined(__GNUC__)
+#define ATTRIBUTE_PURE __attribute__((pure))
+#define ATTRIBUTE_CONST __attribute__((const))
+#define ATTRIBUTE_HOT __attribute__((hot))
+#else
+#define ATTRIBUTE_PURE
+#define ATTRIBUTE_CONST
+#define ATTRIBUTE_HOT
+#endif
+#endif
+
+#ifndef RESTRICT
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L
+#define RESTRICT restrict
+#elif defined(__GNUC__)
+#define RESTRICT __restrict__
+#else
+#define RESTRICT
+#endif
+#endif
+
+TD_Integer DC_Shadow_clampA(TD_Integer counterA) ATTRIBUTE_CONST;
+TD_Integer DC_Shadow_getCounterA(void) ATTRIBUTE_PURE;
+TD_Integer DC_Shadow_getSharedCounter(void) ATTRIBUTE_PURE;
+
+#endif
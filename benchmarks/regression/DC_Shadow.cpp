@@ -0,0 +1,42 @@
+//
+// DC_Shadow.cpp
+//
+
+#include "../GeneralInclude/CompilerSwitches.h"
+#include "../GeneralInclude/DebugSupport.h"
+#include "DC_Shadow.h"
+
+TD_Integer DC_Shadow::counterA = 0;
+TD_Integer DC_Shadow::counterB = 0;
+TD_Integer DC_Shadow::sharedCounter = 0;
+
+DC_Shadow::DC_Shadow(void) {
+  counterA++;
+}
+
+TD_Integer DC_Shadow::clampA(TD_Integer counterA) {
+  return counterA;
+}
+
+TD_Integer DC_Shadow::getCounterA(void) {
+  return counterA;
+}
+
+TD_Integer DC_Shadow::sumB(TD_Integer n) {
+  TD_Integer counterB = n; /* not the counterB
+                              of the class */
+  return counterB + counterA;
+}
+
+TD_Integer DC_Shadow::getCounterB(void) {
+  assert( counterB >= 0 );
+  return counterB;
+}
+
+TD_Integer DC_Shadow::getSharedCounter(void) {
+  return sharedCounter;
+}
+
+void DC_Shadow::setCounterB(TD_Integer value) {
+  counterB = value;
+}
@@ -0,0 +1,58 @@
+//
+// DC_Shadow.h
+//
+// regression case of converter.sh: parameters and local variables named
+// like the class data, and a pure getter following a const method whose
+// parameter is named like the class data. the public class data stay
+// globals, and a getter with an assertion is neither pure nor const.
+
+#ifndef DC_ShadowH
+#define DC_ShadowH
+
+#include "../GeneralInclude/ForwardDeclarations.h"
+#include "../GeneralInclude/BasicTypes.h"
+
+class DC_Shadow {
+
+  private:
+    static TD_Integer counterA;
+    static TD_Integer counterB;
+
+  public:
+    static TD_Integer sharedCounter;
+
+    DC_Shadow(void);
+
+   /**
+    * Return the parameter, which is named like the class data counterA.
+    */
+    static TD_Integer clampA(TD_Integer counterA);
+
+   /**
+    * Return the class data counterA.
+    */
+    static TD_Integer getCounterA(void);
+
+   /**
+    * Add the class data counterA to a local variable named counterB.
+    */
+    static TD_Integer sumB(TD_Integer n);
+
+   /**
+    * Return the class data counterB, which must not be negative.
+    */
+    static TD_Integer getCounterB(void);
+
+   /**
+    * Return the public class data sharedCounter.
+    */
+    static TD_Integer getSharedCounter(void);
+
+   /**
+    * Set the class data counterB.
+    */
+    static void setCounterB(TD_Integer value);
+
+};
+
+#endif
@@ -0,0 +1,146 @@
+#!/bin/bash
+# This script measures the throughput of converter.sh. It first checks that
+# the conversion of examples/CC_RootObject and of the regression cases in
+# benchmarks/regression is still identical to the golden files in
+# benchmarks/golden, then it converts a synthetic corpus generated by
+# generate_classes.sh in project mode and reports the classes and lines
+# converted per second and the peak disk usage of the scratch files.
+
+function usage(){
+   echo "usage: run_benchmark.sh [options]"
+   echo ""
+   echo "options:"
+   echo "  -j N     number of classes converted concurrently, default is the"
+   echo "           number of cores"
+   echo "  -w DIR   working directory, default is a temporary directory which is"
+   echo "           removed at the end"
+   echo "  -c N, -n N, -m N, -k N, -l N, -d N"
+   echo "           shape of the corpus, passed to generate_classes.sh"
+}
+
+bench_dir=$(cd $(dirname $0) && pwd)
+converter=${bench_dir}/../converter.sh
+job_limit=$(nproc 2>/dev/null || echo 1)
+work_dir=''
+generator_options=()
+
+while getopts "j:w:c:n:m:k:l:d:h" option;
+do
+    case "${option}" in
+        j) job_limit=${OPTARG} ;;
+        w) work_dir=${OPTARG} ;;
+        c|n|m|k|l|d) generator_options+=(-${option} ${OPTARG}) ;;
+        h) usage; exit 0 ;;
+        *) usage; exit 1 ;;
+    esac
+done
+
+if [[ ${work_dir} == '' ]];
+then
+    work_dir=$(mktemp -d ${TMPDIR:-/tmp}/benchmark.XXXXXX)
+    trap "rm -rf ${work_dir}" EXIT
+fi
+rm -rf ${work_dir}/golden ${work_dir}/corpus ${work_dir}/converted \
+       ${work_dir}/scratch
+mkdir -p ${work_dir}/golden ${work_dir}/scratch
+
+
+
+###############################################################################
+#                      compare with the golden files
+###############################################################################
+# the golden files are converted with dos2unix available, without it the
+# converted files keep the dos line terminators, so the comparison ignores
+# them. $1 is the directory of the C++ files, $2 the class, and the rest are
+# the options of the conversion.
+golden_status=0
+function check_golden(){
+    local source_dir=$1
+    local class=$2
+    shift 2
+
+    mkdir -p ${work_dir}/golden/${class}
+    cp ${source_dir}/${class}* ${work_dir}/golden/${class}/
+    ( cd ${work_dir}/golden/${class} && \
+      bash ${converter} "$@" ${class}.h > convert.log 2>&1 )
+
+    local status=0
+    for converted_file in ${class}.h ${class}.c
+    do
+        if ! diff <(tr -d '\r' < ${bench_dir}/golden/${converted_file}) \
+                  <(tr -d '\r' < ${work_dir}/golden/${class}/${converted_file}) \
+                  > ${work_dir}/golden/${converted_file}.diff 2>&1;
+        then
+            echo "golden check:    ${converted_file} differs"
+            cat ${work_dir}/golden/${converted_file}.diff
+            status=1
+            golden_status=1
+        fi
+    done
+    if [[ ${status} -eq 0 ]];
+    then
+        echo "golden check:    ${class}.h and ${class}.c are identical"
+    fi
+}
+
+check_golden ${bench_dir}/../examples CC_RootObject
+
+# regression cases, converted with the options they exercise.
+check_golden ${bench_dir}/regression DC_Shadow --layout --attributes
+
+
+
+###############################################################################
+#                      convert the synthetic corpus
+###############################################################################
+bash ${bench_dir}/generate_classes.sh "${generator_options[@]}" \
+     ${work_dir}/corpus > /dev/null
+class_num=$(ls ${work_dir}/corpus/*.h | wc -l)
+line_num=$(cat ${work_dir}/corpus/* | wc -l)
+
+# the scratch directories of project mode are created in TMPDIR, its size is
+# sampled while the conversion is running.
+start=${EPOCHREALTIME/./}
+TMPDIR=${work_dir}/scratch bash ${converter} --no-cache -j ${job_limit} \
+     -o ${work_dir}/converted ${work_dir}/corpus > ${work_dir}/convert.log 2>&1 &
+converter_pid=$!
+
+peak_scratch=0
+while kill -0 ${converter_pid} 2>/dev/null;
+do
+    scratch=$(du -sk ${work_dir}/scratch 2>/dev/null | cut -f1)
+    if [[ ${scratch:-0} -gt ${peak_scratch} ]];
+    then
+        peak_scratch=${scratch}
+    fi
+    sleep 0.05
+done
+wait ${converter_pid}
+convert_status=$?
+elapsed=$((${EPOCHREALTIME/./} - start))
+
+if [[ ${convert_status} -ne 0 ]];
+then
+    echo "conversion of the corpus failed"
+    cat ${work_dir}/convert.log
+    exit 1
+fi
+
+
+
+###############################################################################
+#                               report
+###############################################################################
+echo "classes:         ${class_num}"
+echo "lines:           ${line_num}"
+echo "jobs:            ${job_limit}"
+awk -v elapsed=${elapsed} -v classes=${class_num} -v lines=${line_num} 'BEGIN{
+      seconds = elapsed / 1000000
+      printf "wall time:       %.2f s\n", seconds
+      printf "classes/sec:     %.2f\n", classes / seconds
+      printf "lines/sec:       %.0f\n", lines / seconds
+    }'
+echo "peak scratch:    ${peak_scratch} KB"
+grep "^classes failed\|^ambiguous" ${work_dir}/convert.log
+
+exit ${golden_status}
@@ -0,0 +1,133 @@
+#!/bin/bash
+# This script compares the cost of the calls of a class in c++ with the cost
+# of the same calls with the dispatch of the converted class in c. Each class
+# is converted with --dispatch-benchmark, which mirrors its methods in a c++
+# and a c benchmark; the c benchmark declares its own copies of the converted
+# types instead of including the converted header. It runs on the stub
+# runtime of the qemu object model in benchmarks/dispatch, once with checked
+# casts (CONFIG_QOM_CAST_DEBUG, the default of qemu) and once without, and a
+# table of the ns and instructions per call of each method is printed.
+
+function usage(){
+   echo "usage: run_dispatch_benchmark.sh [options] [cplusplus_header_file...]"
+   echo ""
+   echo "options:"
+   echo "  -n N     number of calls of each method, default is 1000000"
+   echo "  -w DIR   working directory, default is a temporary directory which is"
+   echo "           removed at the end"
+   echo ""
+   echo "the default header is examples/CC_RootObject.h."
+}
+
+bench_dir=$(cd $(dirname $0) && pwd)
+converter=${bench_dir}/../converter.sh
+runtime_dir=${bench_dir}/dispatch
+call_num=1000000
+work_dir=''
+
+while getopts "n:w:h" option;
+do
+    case "${option}" in
+        n) call_num=${OPTARG} ;;
+        w) work_dir=${OPTARG} ;;
+        h) usage; exit 0 ;;
+        *) usage; exit 1 ;;
+    esac
+done
+shift $((OPTIND-1))
+
+headers=("$@")
+if [[ ${#headers[@]} -eq 0 ]];
+then
+    headers=(${bench_dir}/../examples/CC_RootObject.h)
+fi
+
+if [[ ${work_dir} == '' ]];
+then
+    work_dir=$(mktemp -d ${TMPDIR:-/tmp}/dispatch.XXXXXX)
+    trap "rm -rf ${work_dir}" EXIT
+fi
+mkdir -p ${work_dir}
+
+CC=${CC:-gcc}
+CXX=${CXX:-g++}
+CFLAGS=${CFLAGS:--O2}
+CXXFLAGS=${CXXFLAGS:--O2}
+
+
+
+###############################################################################
+#                  convert, build and run the benchmarks
+###############################################################################
+rm -f ${work_dir}/results
+touch ${work_dir}/results
+
+for header in "${headers[@]}";
+do
+    name=$(basename ${header} .h)
+    source_dir=$(dirname ${header})
+    class_dir=${work_dir}/${name}
+
+    rm -rf ${class_dir}
+    mkdir -p ${class_dir}
+    cp ${header} ${class_dir}/
+    for companion in ${name}.cpp ${name}_inl.h;
+    do
+        if [ -e ${source_dir}/${companion} ];
+        then
+            cp ${source_dir}/${companion} ${class_dir}/
+        fi
+    done
+
+    ( cd ${class_dir} && bash ${converter} --dispatch-benchmark ${name}.h ) \
+        > ${class_dir}/convert.log 2>&1
+    self=$(cd ${class_dir} && ls *_bench.cpp 2>/dev/null | sed 's/_bench\.cpp$//')
+    if [[ ${self} == '' ]];
+    then
+        echo "conversion of ${header} failed"
+        cat ${class_dir}/convert.log
+        exit 1
+    fi
+
+    if ! ( cd ${class_dir} && \
+           ${CXX} ${CXXFLAGS} -I${runtime_dir} -o cpp_bench ${self}_bench.cpp && \
+           ${CC} ${CFLAGS} -I${runtime_dir} -o c_bench ${self}_bench.c \
+                 ${runtime_dir}/qom_stub.c && \
+           ${CC} ${CFLAGS} -DCONFIG_QOM_CAST_DEBUG -I${runtime_dir} \
+                 -o c_checked_bench ${self}_bench.c ${runtime_dir}/qom_stub.c ) \
+         > ${class_dir}/build.log 2>&1;
+    then
+        echo "build of the benchmark of ${self} failed"
+        cat ${class_dir}/build.log
+        exit 1
+    fi
+
+    for bench in cpp_bench c_bench c_checked_bench;
+    do
+        ${class_dir}/${bench} ${call_num} > ${class_dir}/${bench}.txt
+    done
+
+    # one row per method: the ns and instructions per call of each benchmark.
+    paste ${class_dir}/cpp_bench.txt ${class_dir}/c_bench.txt \
+          ${class_dir}/c_checked_bench.txt | \
+        awk -F'\t' -v class=${self} '{
+              print class "\t" $1 "\t" $2 "\t" $3 "\t" $7 "\t" $11 "\t" $4 "\t" $8 "\t" $12
+            }' >> ${work_dir}/results
+done
+
+
+
+###############################################################################
+#                               report
+###############################################################################
+awk -F'\t' -v calls=${call_num} '
+      BEGIN {
+        print "calls per method: " calls
+        print ""
+        format = "%-16s %-8s %-24s %9s %9s %9s %9s %9s %9s\n"
+        printf format, "class", "kind", "method", "C++ ns", "C ns", "C ns chk", \
+               "C++ ins", "C ins", "C ins chk"
+      }
+
+      { printf format, $1, $2, $3, $4, $5, $6, $7, $8, $9 }
+    ' ${work_dir}/results
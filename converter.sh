@@ -5,10 +5,1871 @@
 # their syntactic structure; and the second part is to generating wanted code
 # and structure.
 
+function usage(){
+   echo "usage: converter.sh [options] cplusplus_header_file"
+   echo "       converter.sh [options] directory|cplusplus_header_file..."
+   echo "       converter.sh --stream [options] cplusplus_header_file|-"
+   echo ""
+   echo "options:"
+   echo "  -j, --jobs N      number of classes converted concurrently in project"
+   echo "                    mode, default is the number of cores"
+   echo "  -o, --output DIR  directory for converted files in project mode,"
+   echo "                    default is ./converted"
+   echo "  --cache DIR       directory of the conversion cache in project mode,"
+   echo "                    default is .cache in the output directory"
+   echo "  --no-cache        convert all classes even if they are not changed"
+   echo "  --devirtualize    find the virtual methods with a single implementation"
+   echo "                    in the project, emit direct calls for them and report"
+   echo "                    the call sites which can use the direct calls"
+   echo "  --direct-calls FILE"
+   echo "                    emit direct calls for the virtual methods listed in"
+   echo "                    FILE, each line is \"class method root_class n\""
+   echo "  --hierarchy FILE  class hierarchy index used to decide which class"
+   echo "                    struct a virtual method belongs to, project mode"
+   echo "                    writes it to class_hierarchy in the output directory"
+   echo "  --profile         record wall time and process spawns of each phase in"
+   echo "                    \${self}.profile.json, project mode collects them in"
+   echo "                    profile.json in the output directory"
+   echo "  --track-configured"
+   echo "                    keep a count of the objects which are not configured"
+   echo "                    in CC_RootObject, updated by the set* methods of it and"
+   echo "                    its descendants, so isSystemConfigured needs no scan"
+   echo "  --object-pool N   allocate the instances of each class from a static pool"
+   echo "                    of N objects instead of the heap, the size of a pool"
+   echo "                    can be changed with the \${SELF}_POOL_SIZE macro"
+   echo "  --trace-buffer N  buffer the items of synchTrace in a ring buffer of N"
+   echo "                    items (a power of 2) and send them to the tracer as"
+   echo "                    packet traces when it is full or flushed"
+   echo "  --class-id-casts  number the classes of the project so that the cast"
+   echo "                    macros compare integer class identifiers instead of"
+   echo "                    looking up type names, project mode writes them to"
+   echo "                    class_ids.h in the output directory"
+   echo "  --class-ids FILE  class identifiers used by the cast macros"
+   echo "  --export-type-info"
+   echo "                    export the TypeInfo of the class as \${self}_type_info,"
+   echo "                    project mode registers all of them in type_registration.c"
+   echo "  --layout          reorder the fields of the object struct to minimize the"
+   echo "                    padding, gather the class data in one struct and write"
+   echo "                    the layout report to \${self}.layout.txt, project mode"
+   echo "                    collects them in layout.txt in the output directory"
+   echo "  --typedefs FILE   typedefs used to estimate the size of fields, each line"
+   echo "                    is \"name type\", project mode collects them itself"
+   echo "  --attributes      declare trivial getters pure or const and the methods"
+   echo "                    listed by --hot hot, behind portability macros"
+   echo "  --hot FILE        methods to be declared hot with --attributes, each"
+   echo "                    line is \"class method\""
+   echo "  --prune-includes  replace the includes of classes used only by pointer in"
+   echo "                    the header with forward typedefs and move them to the"
+   echo "                    .c, project mode also writes the include graph and"
+   echo "                    build fragments for make and ninja"
+   echo "  --instrument      count the calls and cycles of each method in a static"
+   echo "                    table of the class when compiled with METHOD_PROFILE,"
+   echo "                    and print them with \${self}_dump_profile()"
+   echo "  --dispatch-benchmark"
+   echo "                    write \${self}_bench.cpp and \${self}_bench.c measuring the"
+   echo "                    calls of the methods of the class in c++ and with the"
+   echo "                    dispatch of the converted c, the c side mirrors the"
+   echo "                    converted types instead of including \${self}.h, see"
+   echo "                    benchmarks/run_dispatch_benchmark.sh"
+   echo "  --stream          convert a single class in a private scratch directory"
+   echo "                    without touching the input files, the header is read"
+   echo "                    from stdin if it is -, the converted files are written"
+   echo "                    to stdout (.h first) unless they are given below"
+   echo "  --source FILE     c++ source of the class in stream mode, default is"
+   echo "                    the .cpp next to the header"
+   echo "  --inline FILE     inline header of the class in stream mode, default is"
+   echo "                    the _inl.h next to the header"
+   echo "  --output-header FILE"
+   echo "                    where stream mode writes the converted .h file"
+   echo "  --output-source FILE"
+   echo "                    where stream mode writes the converted .c file"
+}
+
+job_limit=$(nproc 2>/dev/null || echo 1)
+output_dir=converted
+cache_dir=''
+use_cache="yes"
+devirtualize="no"
+direct_calls_file=''
+hierarchy_file=''
+profile="no"
+track_configured="no"
+object_pool_size=''
+trace_buffer_size=''
+class_id_casts="no"
+class_ids_file=''
+export_type_info="no"
+layout="no"
+typedefs_file=''
+attributes="no"
+hot_file=''
+prune_includes="no"
+instrument="no"
+dispatch_benchmark="no"
+stream="no"
+stream_source=''
+stream_inline=''
+stream_output_header=''
+stream_output_source=''
+
+while [[ $# -gt 0 ]];
+do
+    case "$1" in
+        -j|--jobs)
+            job_limit=$2
+            shift 2
+            ;;
+        -o|--output)
+            output_dir=$2
+            shift 2
+            ;;
+        --cache)
+            cache_dir=$2
+            shift 2
+            ;;
+        --no-cache)
+            use_cache="no"
+            shift
+            ;;
+        --devirtualize)
+            devirtualize="yes"
+            shift
+            ;;
+        --direct-calls)
+            direct_calls_file=$(readlink -f $2)
+            shift 2
+            ;;
+        --hierarchy)
+            hierarchy_file=$(readlink -f $2)
+            shift 2
+            ;;
+        --profile)
+            profile="yes"
+            shift
+            ;;
+        --track-configured)
+            track_configured="yes"
+            shift
+            ;;
+        --object-pool)
+            object_pool_size=$2
+            shift 2
+            ;;
+        --trace-buffer)
+            trace_buffer_size=$2
+            shift 2
+            ;;
+        --class-id-casts)
+            class_id_casts="yes"
+            shift
+            ;;
+        --class-ids)
+            class_ids_file=$(readlink -f $2)
+            shift 2
+            ;;
+        --export-type-info)
+            export_type_info="yes"
+            shift
+            ;;
+        --layout)
+            layout="yes"
+            shift
+            ;;
+        --typedefs)
+            typedefs_file=$(readlink -f $2)
+            shift 2
+            ;;
+        --attributes)
+            attributes="yes"
+            shift
+            ;;
+        --hot)
+            hot_file=$(readlink -f $2)
+            shift 2
+            ;;
+        --prune-includes)
+            prune_includes="yes"
+            shift
+            ;;
+        --instrument)
+            instrument="yes"
+            shift
+            ;;
+        --dispatch-benchmark)
+            dispatch_benchmark="yes"
+            shift
+            ;;
+        --stream)
+            stream="yes"
+            shift
+            ;;
+        --source)
+            stream_source=$2
+            shift 2
+            ;;
+        --inline)
+            stream_inline=$2
+            shift 2
+            ;;
+        --output-header)
+            stream_output_header=$2
+            shift 2
+            ;;
+        --output-source)
+            stream_output_source=$2
+            shift 2
+            ;;
+        -h|--help)
+            usage
+            exit 0
+            ;;
+        --)
+            shift
+            break
+            ;;
+        -)
+            break
+            ;;
+        -*)
+            echo "unknown option: $1"
+            usage
+            exit 1
+            ;;
+        *)
+            break
+            ;;
+    esac
+done
+
 if [[ $# -lt 1 ]];
 then
-   echo "usage: converter.sh cplusplus_header_file"
-   exit 1
+   usage
+   exit 1
+fi
+
+if [[ ! ${job_limit} =~ ^[1-9][0-9]*$ ]];
+then
+   echo "the number of jobs should be a positive integer"
+   exit 1
+fi
+
+if [[ ${object_pool_size} != '' && ! ${object_pool_size} =~ ^[1-9][0-9]*$ ]];
+then
+   echo "the size of object pool should be a positive integer"
+   exit 1
+fi
+
+if [[ ${trace_buffer_size} != '' ]] && \
+   [[ ! ${trace_buffer_size} =~ ^[1-9][0-9]*$ || \
+      $((trace_buffer_size & (trace_buffer_size - 1))) -ne 0 ]];
+then
+   echo "the size of trace buffer should be a power of 2"
+   exit 1
+fi
+
+
+
+
+
+###############################################################################
+#
+#                             common functions 
+#
+###############################################################################
+
+# print the class name and its parent name in the form of "self/parent".
+# for the cplusplus souce file only has single inheritance, and the qemu object
+# model only support single inheritance in this way (multi inheritance can be
+# do by using interfaces in qemu), we here just tackle this case.
+# forward declarations like "class Foo;" are skipped.
+function extract_class_and_parent(){
+    awk '
+       # the class has parent
+       /^[\t ]*class/ && !/;/ && /\:/{
+         gsub(/(class|\:|public|protected|\{)/, " ")
+         split($0, ary, " ")
+         print ary[1]"/"ary[2]
+         exit 0 
+       }
+       # the class has no parent
+       /^[\t ]*class/ && !/;/{
+         gsub(/(class|\:|public|protected|\{)/, "")
+         split($0, ary, " ")
+         print ary[1]"/"
+         exit 0
+       }
+     ' $1
+}
+
+
+# print a index of all function bodies in a file with a single pass, each
+# line of the index is in the form of "class::func_name body_start body_end".
+# instead of assuming the end of function "}" is at the begin of line, we track
+# the depth of braces, so the function body can be indented arbitrarily.
+# a body beginning on the line of its "{", such as "int f() { return x; }", is
+# moved to a line of its own, the line numbers are those of the file written
+# to $2 with the moved bodies; without $2 only the keys are of use.
+function index_function_bodies(){
+
+   awk '
+      BEGIN{
+          depth = 0;
+          pending = 0;
+          is_function_body = 0;
+          in_comment = 0;
+          line_num = 0;
+      }
+
+      function emit(text){
+          line_num++
+          if (normalized != "") print text > normalized
+      }
+
+      {
+          # strip string/char literals and comments, for braces in them
+          # should not be counted.
+          line = $0
+          gsub(/\\./, "", line)
+          gsub(/"[^"]*"/, "", line)
+          gsub(/\047[^\047]*\047/, "", line)
+          if (in_comment) {
+              if (match(line, /\*\//)) {
+                  line = substr(line, RSTART + RLENGTH)
+                  in_comment = 0
+              } else {
+                  line = ""
+              }
+          }
+          gsub(/\/\*([^*]|\*+[^*\/])*\*+\//, "", line)
+          if (match(line, /\/\*/)) {
+              line = substr(line, 1, RSTART - 1)
+              in_comment = 1
+          }
+          sub(/\/\/.*/, "", line)
+
+          # find the function at the top level
+          if (depth == 0 && !pending && !is_function_body &&
+              match(line, /[a-zA-Z_][a-zA-Z_0-9]*::~?[a-zA-Z_][a-zA-Z_0-9]* *\(/)){
+              key = substr(line, RSTART, RLENGTH - 1)
+              sub(/ +$/, "", key)
+              pending = 1
+          }
+
+          # a declaration but not a definition
+          if (pending && depth == 0 && line ~ /;/ && line !~ /\{/){
+              pending = 0
+              emit($0)
+              next
+          }
+
+          opened = gsub(/\{/, "{", line)
+          closed = gsub(/\}/, "}", line)
+
+          if (pending && opened > 0 && depth == 0){
+              is_function_body = 1
+              pending = 0
+
+              # the body following "{" on the same line gets its own line.
+              brace = index($0, "{")
+              rest = substr($0, brace + 1)
+              if (rest ~ /[^ \t\r]/) {
+                  emit(substr($0, 1, brace))
+                  emit(rest)
+                  body_start = line_num
+              } else {
+                  emit($0)
+                  body_start = line_num + 1
+              }
+          } else {
+              emit($0)
+          }
+
+          depth += opened - closed
+          if (depth < 0) depth = 0
+
+          if (is_function_body && depth == 0){
+              # the first definition wins if the name is overloaded.
+              if (!(key in seen)){
+                  seen[key] = 1
+                  print key, body_start, line_num
+              }
+              is_function_body = 0
+          }
+      }
+     ' normalized=$2 $1
+}
+
+
+
+
+
+# the profile of a conversion is a list of phases, each one records its wall
+# time in microseconds and the number of processes spawned; calling this
+# function ends the current phase and begins the phase named $1, an empty
+# name only ends the current phase. the number of processes spawned is the
+# increment of the last pid of the pid namespace, which is exact as long as
+# nothing else creates processes concurrently. reading the clock and the pid
+# counter does not spawn any process by itself.
+profile_phases=()
+function profile_phase(){
+
+    [[ ${profile} == "yes" ]] || return 0
+
+    local now=${EPOCHREALTIME/./}
+    local last_pid=-1
+    read last_pid < /proc/sys/kernel/ns_last_pid 2>/dev/null
+
+    if [[ ${phase_name} != '' ]];
+    then
+        local spawns=-1
+        if [[ ${last_pid} -ge 0 && ${phase_last_pid} -ge 0 ]];
+        then
+            # the pid counter wraps around at pid_max
+            local pid_max=4194304
+            read pid_max < /proc/sys/kernel/pid_max 2>/dev/null
+            spawns=$(( (last_pid - phase_last_pid + pid_max) % pid_max ))
+        fi
+        profile_phases+=("${phase_name} $((now - phase_start)) ${spawns}")
+    fi
+
+    phase_name=$1
+    phase_start=${now}
+    phase_last_pid=${last_pid}
+}
+
+
+# print the profile of a conversion as JSON, the counters are given in the
+# form of "name=value".
+function print_profile_json(){
+
+    local total_us=0
+    local total_spawns=0
+
+    echo "{"
+    echo "  \"class\": \"${self}\","
+    echo "  \"converter_version\": \"$(sha1sum < ${BASH_SOURCE[0]} | cut -d' ' -f1)\","
+    echo "  \"phases\": ["
+    for ((i=0; i<${#profile_phases[@]}; i++));
+    do
+        read name wall_us spawns <<< "${profile_phases[$i]}"
+        total_us=$((total_us + wall_us))
+        total_spawns=$((total_spawns + spawns))
+
+        separator=","
+        [[ $i -eq $((${#profile_phases[@]} - 1)) ]] && separator=""
+        echo "    {\"name\": \"${name}\", \"wall_us\": ${wall_us}, \"spawns\": ${spawns}}${separator}"
+    done
+    echo "  ],"
+    echo "  \"total_wall_us\": ${total_us},"
+    echo "  \"total_spawns\": ${total_spawns},"
+    echo "  \"counters\": {"
+    for ((i=1; i<=$#; i++));
+    do
+        separator=","
+        [[ $i -eq $# ]] && separator=""
+        counter=${!i}
+        echo "    \"${counter%=*}\": ${counter#*=}${separator}"
+    done
+    echo "  }"
+    echo "}"
+}
+
+
+# print the profile of a project conversion as JSON: the wall time of the
+# whole project, the totals of each phase over all classes and the profile of
+# each class; $1 is the wall time and $2 is a file listing the class profiles.
+function print_project_profile_json(){
+
+    echo "{"
+    echo "  \"converter_version\": \"$(sha1sum < ${BASH_SOURCE[0]} | cut -d' ' -f1)\","
+    echo "  \"jobs\": ${job_limit},"
+    echo "  \"wall_us\": $1,"
+    echo "  \"phase_totals\": ["
+    cat $(cat $2) /dev/null | awk '
+       /"name": .*"wall_us": .*"spawns": / {
+         gsub(/[{}",:]/, " ")
+         if (!($2 in wall_us)) order[++phase_num] = $2
+         wall_us[$2] += $4
+         spawns[$2] += $6
+       }
+       END {
+         for (i = 1; i <= phase_num; i++) {
+           printf "    {\"name\": \"%s\", \"wall_us\": %d, \"spawns\": %d}%s\n",
+                  order[i], wall_us[order[i]], spawns[order[i]],
+                  i < phase_num ? "," : ""
+         }
+       }'
+    echo "  ],"
+    echo "  \"classes\": ["
+    local profile_num=$(wc -l < $2)
+    local i=0
+    while read class_profile;
+    do
+        i=$((i+1))
+        if [[ $i -lt ${profile_num} ]];
+        then
+            sed '$s/$/,/' ${class_profile}
+        else
+            cat ${class_profile}
+        fi
+    done < $2
+    echo "  ]"
+    echo "}"
+}
+
+
+# print the names of a parameter list separated by ", ", for example:
+# "int a, const char *b" ---> "a, b"
+function formal_parameter_names(){
+
+    local list=''
+
+    echo "$1" | tr ',' '\n' | \
+    sed \
+        -e 's/\([a-zA-Z_\*]\+\) \+\([a-zA-Z_]\)/\2/g'\
+        -e 's/\([a-zA-Z_]\+\) \+\**\([a-zA-Z_]\+\)/\2/g'\
+        -e 's/^[ ]\+//g' | \
+    while read line;
+    do
+        if [[ $list == '' ]];
+        then 
+            list="$line"; 
+        else 
+            list="$list, $line"; 
+        fi;
+        echo "$list"
+    done | tail -1
+}
+
+
+# print a index of the class hierarchy declared in the given headers, there
+# are two kinds of records:
+# "class self parent header" for each class, parent is Object if it has none;
+# "virtual self func_name pure|impl" for each virtual method a class declares.
+function index_class_hierarchy(){
+    awk '
+       FNR == 1 {
+         self = ""
+       }
+
+       {
+         line = $0
+         sub(/^[\t ]+/, "", line)
+         sub(/\r$/, "", line)
+       }
+
+       # skip comments
+       line ~ /^(\/|\*)/ {
+         next
+       }
+
+       # the same rule as extract_class_and_parent
+       self == "" && line ~ /^class/ && line !~ /;/ {
+         has_parent = line ~ /\:/
+         gsub(/(class|\:|public|protected|\{)/, " ", line)
+         split(line, ary, " ")
+         self = ary[1]
+         parent = (has_parent && ary[2] != "") ? ary[2] : "Object"
+         print "class", self, parent, FILENAME
+         next
+       }
+
+       self != "" && line ~ /(^|[\t ])virtual[\t ]/ && line ~ /\(/ {
+         decl = line
+         sub(/ *\(.*/, "", decl)
+         n = split(decl, words, /[\t \*&]+/)
+         func_name = words[n]
+
+         # virtual destructor is not a method we can bind
+         if (func_name ~ /^~/ || func_name == "") next
+
+         print "virtual", self, func_name, (line ~ /= *0 *;/) ? "pure" : "impl"
+       }
+     ' "$@"
+}
+
+
+# print the virtual methods declared in the ancestors of a class, starting from
+# its parent, in the form of "func_name owner", where owner is the topmost
+# ancestor declaring it; the last line is "- yes|no" telling whether all the
+# ancestors up to Object are in the index.
+function resolve_ancestor_virtuals(){
+    awk '
+       $1 == "class" {
+         parent[$2] = $3
+       }
+
+       $1 == "virtual" {
+         declares[$2, $3] = 1
+         names[$3] = 1
+       }
+
+       END {
+         complete = "no"
+         depth = 0
+         for (c = start; depth < 256; c = parent[c]) {
+           if (c == "Object") {
+             complete = "yes"
+             break
+           }
+           if (!(c in parent)) break
+
+           # the upper ancestor overrides the lower one.
+           for (func_name in names) {
+             if ((c, func_name) in declares) owner[func_name] = c
+           }
+           depth++
+         }
+
+         for (func_name in owner) print func_name, owner[func_name]
+         print "-", complete
+       }
+     ' start=$2 $1
+}
+
+
+# tell whether a class is derived, directly or not, from the given ancestor
+# with the class hierarchy index, print "yes" or "no".
+function is_derived_from(){
+    awk '
+       $1 == "class" {
+         parent[$2] = $3
+       }
+
+       END {
+         derived = "no"
+         depth = 0
+         for (c = parent[start]; (c in parent) && depth < 256; c = parent[c]) {
+           if (c == ancestor) {
+             derived = "yes"
+             break
+           }
+           depth++
+         }
+         print derived
+       }
+     ' start=$2 ancestor=$3 $1
+}
+
+
+# print the header of class identifiers for the class hierarchy index: the
+# classes of each tree rooted at Object are numbered in preorder, so a class
+# and all its descendants have the identifiers TYPE_ID_X..TYPE_ID_X_LAST, and
+# a checked cast only compares the identifier of the class with the range.
+function generate_class_ids(){
+    awk '$1 == "class" { print $2, $3 }' $1 | sort | awk '
+       function number(c,    kids, kid_num, k) {
+         next_id++
+         id[c] = next_id
+         name[next_id] = c
+         kid_num = split(children[c], kids, " ")
+         for (k = 1; k <= kid_num; k++) number(kids[k])
+         last[c] = next_id
+       }
+
+       {
+         children[$2] = children[$2] " " $1
+       }
+
+       END {
+         next_id = 0
+         root_num = split(children["Object"], roots, " ")
+         for (i = 1; i <= root_num; i++) number(roots[i])
+
+         print "// class identifiers generated by converter.sh, the identifiers of a class"
+         print "// and its descendants are TYPE_ID_X..TYPE_ID_X_LAST."
+         print ""
+         print "#ifndef CLASS_IDS_H"
+         print "#define CLASS_IDS_H"
+         print ""
+         print "#include <assert.h>"
+         print ""
+         for (i = 1; i <= next_id; i++) {
+           c = name[i]
+           printf "#define TYPE_ID_%s %d\n", toupper(c), id[c]
+           printf "#define TYPE_ID_%s_LAST %d\n", toupper(c), last[c]
+         }
+         print ""
+         print "// the class struct of each root class starts with these members, the"
+         print "// identifier is set by class_init of each class."
+         print "typedef struct TypeIdClass {"
+         print "    ObjectClass parent_class;"
+         print "    unsigned int type_id;"
+         print "} TypeIdClass;"
+         print ""
+         print "#define TYPE_ID_OF_CLASS(klass) (((TypeIdClass*)(klass))->type_id)"
+         print ""
+         print "#ifdef UNCHECKED_CASTS"
+         print "#define TYPE_ID_CHECK_CLASS(klass, id) (klass)"
+         print "#define TYPE_ID_CHECK(obj, id) (obj)"
+         print "#else"
+         print "static inline void *type_id_check_class(void *klass, unsigned int first,"
+         print "                                        unsigned int last)"
+         print "{"
+         print "    assert( TYPE_ID_OF_CLASS(klass) >= first &&"
+         print "            TYPE_ID_OF_CLASS(klass) <= last );"
+         print "    return klass;"
+         print "}"
+         print ""
+         print "static inline void *type_id_check(void *obj, unsigned int first,"
+         print "                                  unsigned int last)"
+         print "{"
+         print "    type_id_check_class(((Object*)obj)->class, first, last);"
+         print "    return obj;"
+         print "}"
+         print ""
+         print "#define TYPE_ID_CHECK_CLASS(klass, id) \\"
+         print "        type_id_check_class(klass, id, id##_LAST)"
+         print "#define TYPE_ID_CHECK(obj, id) \\"
+         print "        type_id_check(obj, id, id##_LAST)"
+         print "#endif"
+         print ""
+         print "#endif"
+       }
+     '
+}
+
+
+# print the classes of the class hierarchy index in preorder, so every parent
+# class is before its children; the trees rooted at a class out of the index
+# follow the trees rooted at Object.
+function order_classes_by_hierarchy(){
+    awk '$1 == "class" { print $2, $3 }' $1 | sort | awk '
+       function visit(c,    kids, kid_num, k) {
+         print c
+         kid_num = split(children[c], kids, " ")
+         for (k = 1; k <= kid_num; k++) visit(kids[k])
+       }
+
+       {
+         parent[$1] = $2
+         children[$2] = children[$2] " " $1
+         classes[++class_num] = $1
+       }
+
+       END {
+         root_num = split(children["Object"], roots, " ")
+         for (i = 1; i <= root_num; i++) visit(roots[i])
+
+         for (i = 1; i <= class_num; i++) {
+           c = classes[i]
+           if (parent[c] != "Object" && !(parent[c] in parent)) visit(c)
+         }
+       }
+     '
+}
+
+
+# print the registration unit of the classes read from stdin, which are in
+# the order of registration: the exported TypeInfo of all classes are kept in
+# a single array and registered in one loop. $1 is the path of Qom/object.h
+# relative to the unit.
+function generate_type_registration(){
+    mapfile -t classes
+
+    echo "// type registration generated by converter.sh, every parent class is"
+    echo "// registered before its children."
+    echo ""
+    echo "#include \"$1\""
+    echo "#include \"type_registration.h\""
+    echo ""
+
+    for class in "${classes[@]}";
+    do
+        echo "extern const TypeInfo ${class}_type_info;"
+    done
+
+    echo ""
+    echo "static const TypeInfo *const type_infos[] = {"
+    for class in "${classes[@]}";
+    do
+        echo "    &${class}_type_info,"
+    done
+    echo "};"
+    echo ""
+    echo "void register_all_types(void)"
+    echo "{"
+    echo "    for (unsigned int i=0; i<sizeof(type_infos)/sizeof(type_infos[0]); i++)"
+    echo "        type_register_static(type_infos[i]);"
+    echo "}"
+}
+
+
+# write the include graph of the converted files in the given directory to
+# include_graph.dot, and the dependencies of their objects to build.mk and
+# build.ninja, with the paths relative to the directory. includes which are
+# not converted files, such as Qom/object.h, are left out, and so are the
+# files of the conversion cache, which is .cache or the directory $2 when it
+# is in the output directory.
+function generate_build_graph(){
+    local output_dir=$1
+    local cache_path=.cache
+    if [[ $2 != '' ]];
+    then
+        cache_path=$(realpath -m --relative-to=${output_dir} $2)
+    fi
+
+    ( cd ${output_dir} && \
+      find . \( -path ./.cache -o -path "./${cache_path}" \) -prune -o \
+           -name "*.[ch]" ! -name "*_bench.c" -print | \
+        sed 's|^\./||' | sort ) | awk '
+      function exists(path,    line, status) {
+        status = (getline line < path)
+        close(path)
+        return status >= 0
+      }
+
+      # join the directory of a file with an included path, removing the "."
+      # and ".." parts.
+      function resolve(dir, path,    parts, n, i, k, stack) {
+        n = split(dir "/" path, parts, "/")
+        k = 0
+        for (i = 1; i <= n; i++) {
+          if (parts[i] == "" || parts[i] == ".") continue
+          if (parts[i] == ".." && k > 0 && stack[k] != "..") { k--; continue }
+          stack[++k] = parts[i]
+        }
+        path = ""
+        for (i = 1; i <= k; i++) path = path (i > 1 ? "/" : "") stack[i]
+        return path
+      }
+
+      # the headers included by a file, directly or not.
+      function collect(file, source,    i, dependency) {
+        for (i = 1; i <= edge_num[file]; i++) {
+          dependency = edge[file, i]
+          if ((source, dependency) in seen) continue
+          seen[source, dependency] = 1
+          dependencies[source] = dependencies[source] " " dependency
+          collect(dependency, source)
+        }
+      }
+
+      {
+        files[++file_num] = $0
+        dir = $0
+        if (!sub(/\/[^\/]*$/, "", dir)) dir = "."
+
+        path = root "/" $0
+        while ((getline line < path) > 0) {
+          if (line !~ /^#include *"/) continue
+          included = line
+          sub(/^#include *"/, "", included)
+          sub(/".*/, "", included)
+
+          # relative to the including file first, then to the directory.
+          target = resolve(dir, included)
+          if (!exists(root "/" target)) {
+            target = resolve(".", included)
+            if (!exists(root "/" target)) continue
+          }
+          edge[$0, ++edge_num[$0]] = target
+        }
+        close(path)
+      }
+
+      END {
+        graph = root "/include_graph.dot"
+        print "digraph includes {" > graph
+        for (f = 1; f <= file_num; f++)
+          for (i = 1; i <= edge_num[files[f]]; i++)
+            print "    \"" files[f] "\" -> \"" edge[files[f], i] "\";" > graph
+        print "}" > graph
+
+        mk = root "/build.mk"
+        print "# dependencies of the converted files generated by converter.sh, the" > mk
+        print "# paths are relative to the output directory." > mk
+        print "CONVERTED_CPPFLAGS ?= -I." > mk
+        print "CONVERTED_SOURCES = \\" > mk
+        for (f = 1; f <= file_num; f++)
+          if (files[f] ~ /\.c$/) print "    " files[f] " \\" > mk
+        print "" > mk
+        print "CONVERTED_OBJECTS = $(CONVERTED_SOURCES:.c=.o)" > mk
+        print "" > mk
+        print ".PHONY: converted_objects" > mk
+        print "converted_objects: $(CONVERTED_OBJECTS)" > mk
+        print "" > mk
+        print "$(CONVERTED_OBJECTS): %.o: %.c" > mk
+        print "\t$(CC) $(CFLAGS) $(CONVERTED_CPPFLAGS) -c $< -o $@" > mk
+        print "" > mk
+
+        ninja = root "/build.ninja"
+        print "# dependencies of the converted files generated by converter.sh, the" > ninja
+        print "# paths are relative to the output directory." > ninja
+        print "converted_cc = cc" > ninja
+        print "converted_cflags = -I." > ninja
+        print "" > ninja
+        print "rule converted_cc" > ninja
+        print "  command = $converted_cc $converted_cflags -c $in -o $out" > ninja
+        print "  description = CC $out" > ninja
+        print "" > ninja
+
+        objects = ""
+        for (f = 1; f <= file_num; f++) {
+          if (files[f] !~ /\.c$/) continue
+          collect(files[f], files[f])
+          object = files[f]
+          sub(/\.c$/, ".o", object)
+          objects = objects " " object
+          print object ": " files[f] dependencies[files[f]] > mk
+          print "build " object ": converted_cc " files[f] \
+                (dependencies[files[f]] == "" ? "" : " |" dependencies[files[f]]) > ninja
+        }
+        print "" > ninja
+        print "build converted_objects: phony" objects > ninja
+      }
+    ' root=${output_dir}
+}
+
+
+# print the typedefs declared in a single line in the given files, in the form
+# of "name type", they are used to estimate the size of fields.
+function collect_typedefs(){
+    awk '
+       {
+         line = $0
+         sub(/\r$/, "", line)
+       }
+
+       line ~ /^[\t ]*typedef[\t ]/ && line ~ /;/ && line !~ /[(){}]/ {
+         sub(/^[\t ]*typedef[\t ]+/, "", line)
+         sub(/[\t ]*;.*/, "", line)
+         n = split(line, words, /[\t ]+/)
+         if (n < 2 || words[n] ~ /[^a-zA-Z_0-9]/) next
+
+         type = words[1]
+         for (i = 2; i < n; i++) type = type " " words[i]
+         print words[n], type
+       }
+     ' "$@"
+}
+
+
+# reorder the field declarations in file $2, one in each line, to minimize
+# the padding of struct $1: fields are ordered by alignment, and fields with
+# the same alignment by the number of references in the source files given
+# after $4, the most referenced first. the reordered declarations are printed
+# and a layout report is written to $3. sizes are estimated for a 64-bit
+# target, with the typedefs in file $4 ("name type" in each line).
+# if init_file is set in the environment, the declarations are printed without
+# "static" and initial value, the initial values are written to init_file as
+# designated initializers.
+function layout_fields(){
+
+    local struct_name=$1
+    local field_file=$2
+    local report_file=$3
+    local typedef_file=${4:-/dev/null}
+    shift 4
+
+    awk '
+       function size_of(type,    depth) {
+         for (depth = 0; depth < 16; depth++) {
+           if (type ~ /\*/) return 8
+           gsub(/(^|[\t ])(const|volatile|signed)([\t ]|$)/, " ", type)
+           gsub(/^[\t ]+|[\t ]+$/, "", type)
+           gsub(/[\t ]+/, " ", type)
+           if (type in builtin) return builtin[type]
+           if (!(type in typedef)) break
+           type = typedef[type]
+         }
+         unknown_num++
+         return 4
+       }
+
+       BEGIN {
+         builtin["char"] = 1; builtin["unsigned char"] = 1; builtin["bool"] = 1
+         builtin["short"] = 2; builtin["unsigned short"] = 2
+         builtin["short int"] = 2; builtin["unsigned short int"] = 2
+         builtin["int"] = 4; builtin["unsigned int"] = 4; builtin["unsigned"] = 4
+         builtin["float"] = 4
+         builtin["long"] = 8; builtin["unsigned long"] = 8
+         builtin["long int"] = 8; builtin["unsigned long int"] = 8
+         builtin["long long"] = 8; builtin["unsigned long long"] = 8
+         builtin["double"] = 8; builtin["size_t"] = 8
+       }
+
+       FILENAME == typedef_file {
+         name = $1
+         sub(/^[^ ]+ /, "")
+         typedef[name] = $0
+         next
+       }
+
+       FILENAME == field_file {
+         line = $0
+         sub(/\r$/, "", line)
+         if (line ~ /^[\t ]*$/) next
+
+         decl = line
+         sub(/^[\t ]+/, "", decl)
+         sub(/^static[\t ]+/, "", decl)
+         init = ""
+         if (match(decl, / *= */)) {
+           init = substr(decl, RSTART + RLENGTH)
+           sub(/ *;.*/, "", init)
+           decl = substr(decl, 1, RSTART - 1)
+         }
+         sub(/ *;.*/, "", decl)
+
+         match(decl, /[a-zA-Z_][a-zA-Z_0-9]*(\[[^\]]*\])* *$/)
+         type = substr(decl, 1, RSTART - 1)
+         declarator = substr(decl, RSTART)
+         name = declarator
+         sub(/\[.*/, "", name)
+
+         count = 1
+         dim_num = split(declarator, dims, /\[/)
+         for (d = 2; d <= dim_num; d++) {
+           sub(/\].*/, "", dims[d])
+           if (dims[d] ~ /^[0-9]+$/) count *= dims[d]
+         }
+
+         field_num++
+         field_line[field_num] = $0
+         field_decl[field_num] = type declarator
+         field_init[field_num] = init
+         field_name[field_num] = name
+         field_align[field_num] = size_of(type)
+         field_size[field_num] = field_align[field_num] * count
+         field_index[name] = field_num
+         next
+       }
+
+       # count the references of fields in the sources
+       {
+         n = split($0, words, /[^a-zA-Z_0-9]+/)
+         for (i = 1; i <= n; i++) {
+           if (words[i] in field_index) refs[field_index[words[i]]]++
+         }
+       }
+
+       function layout(order,    i, f, offset, max_align, padding) {
+         offset = 0
+         max_align = 1
+         padding = 0
+         for (i = 1; i <= field_num; i++) {
+           f = order[i]
+           if (offset % field_align[f] != 0) {
+             padding += field_align[f] - offset % field_align[f]
+             offset += field_align[f] - offset % field_align[f]
+           }
+           offset += field_size[f]
+           if (field_align[f] > max_align) max_align = field_align[f]
+         }
+         if (offset % max_align != 0) {
+           padding += max_align - offset % max_align
+           offset += max_align - offset % max_align
+         }
+         layout_padding = padding
+         return offset
+       }
+
+       function before(a, b) {
+         if (field_align[a] != field_align[b]) return field_align[a] > field_align[b]
+         if (refs[a] != refs[b]) return refs[a] > refs[b]
+         return a < b
+       }
+
+       END {
+         for (i = 1; i <= field_num; i++) original[i] = i
+
+         # insertion sort, structs have a few fields.
+         for (i = 1; i <= field_num; i++) {
+           f = i
+           for (j = i - 1; j >= 1 && before(f, sorted[j]); j--) sorted[j + 1] = sorted[j]
+           sorted[j + 1] = f
+         }
+
+         old_size = layout(original)
+         old_padding = layout_padding
+         new_size = layout(sorted)
+         new_padding = layout_padding
+
+         order = ""
+         for (i = 1; i <= field_num; i++) {
+           f = sorted[i]
+           order = order " " field_name[f]
+           if (init_file == "") {
+             print field_line[f]
+           } else {
+             print "    " field_decl[f] ";"
+             if (field_init[f] != "") {
+               print "    ." field_name[f] " = " field_init[f] "," > init_file
+             }
+           }
+         }
+
+         print "struct " struct_name > report_file
+         printf "    fields:      %d, %d of unknown size assumed 4 bytes\n", \
+                field_num, unknown_num > report_file
+         printf "    size:        %d bytes, was %d bytes\n", new_size, old_size > report_file
+         printf "    padding:     %d bytes, was %d bytes\n", new_padding, old_padding > report_file
+         printf "    cache lines: %d of 64 bytes\n", int((new_size + 63) / 64) > report_file
+         print "    order:      " order > report_file
+       }
+     ' struct_name="${struct_name}" report_file=${report_file} \
+       typedef_file=${typedef_file} field_file=${field_file} \
+       init_file="${init_file}" ${typedef_file} ${field_file} "$@"
+}
+
+
+# find the virtual methods which have a single implementation in the whole
+# class hierarchy, a virtual method belongs to the topmost class (root class)
+# declaring it; each line of the output is "class func_name root_class n",
+# where class has the single implementation and n is the number of different
+# root classes declaring a virtual method with the same name.
+function find_devirtualizable_methods(){
+    awk '
+       $1 == "class" {
+         parent[$2] = $3
+       }
+
+       $1 == "virtual" {
+         kind[$2, $3] = $4
+         decl_num++
+         decl_class[decl_num] = $2
+         decl_func[decl_num] = $3
+       }
+
+       END {
+         for (i = 1; i <= decl_num; i++) {
+           self = decl_class[i]
+           func_name = decl_func[i]
+
+           root = self
+           depth = 0
+           for (p = parent[self]; (p in parent) && depth < 256; p = parent[p]) {
+             if ((p, func_name) in kind) root = p
+             depth++
+           }
+
+           if (!((root, func_name) in roots)) {
+             roots[root, func_name] = 1
+             root_num[func_name]++
+           }
+
+           if (kind[self, func_name] == "impl") {
+             impl_num[root, func_name]++
+             impl_class[root, func_name] = self
+           }
+         }
+
+         for (key in impl_num) {
+           if (impl_num[key] != 1) continue
+           split(key, ary, SUBSEP)
+           print impl_class[key], ary[2], ary[1], root_num[ary[2]]
+         }
+       }
+     ' $1 | sort
+}
+
+
+# report the call sites of the devirtualizable methods in the given source
+# files, in the form of "file:line: func_name -> direct_call (safe|unsafe...)".
+# a call site is safe if no other class tree declares a virtual method with
+# the same name, or the call is unqualified in a method of the class tree.
+function report_direct_call_sites(){
+
+    local direct_calls=$1
+    local hierarchy=$2
+    shift 2
+
+    awk '
+       FILENAME == direct_calls {
+         direct[$2] = $1 "_" $2 "_direct"
+         root_of[$2] = $3
+         root_num[$2] = $4
+         next
+       }
+
+       FILENAME == hierarchy {
+         if ($1 == "class") parent[$2] = $3
+         next
+       }
+
+       FNR == 1 {
+         # the class of a source file is the class of the header with the
+         # same name.
+         file_class = FILENAME
+         sub(/.*\//, "", file_class)
+         sub(/(_inl\.h|\.cpp)$/, "", file_class)
+       }
+
+       /^[\t ]*(\/\/|\*)/ {
+         next
+       }
+
+       {
+         for (func_name in direct) {
+           qualified = "(->|\\.)[\t ]*" func_name "[\t ]*\\("
+           unqualified = "(^|[^a-zA-Z_0-9:>.~])" func_name "[\t ]*\\("
+
+           if ($0 ~ qualified) {
+             safe = root_num[func_name] == 1
+           } else if ($0 ~ unqualified && $0 !~ "::[\t ]*" func_name "[\t ]*\\(") {
+             safe = 0
+             for (c = file_class; c in parent; c = parent[c]) {
+               if (c == root_of[func_name]) safe = 1
+             }
+           } else {
+             continue
+           }
+
+           printf "%s:%d: %s -> %s %s\n", FILENAME, FNR, func_name,
+                  direct[func_name], safe ? "(safe)" : \
+                  "(unsafe: " root_num[func_name] " class trees declare it)"
+         }
+       }
+     ' direct_calls=${direct_calls} hierarchy=${hierarchy} \
+       ${direct_calls} ${hierarchy} "$@"
+}
+
+
+###############################################################################
+#
+#                             project mode 
+#
+###############################################################################
+
+# a single class converted in a private scratch directory: the header, the
+# source and the inline header of the class are copied there, so that neither
+# the input files nor other classes being converted are touched; the converted
+# files are copied into ${output_dir} keeping the relative path of the header.
+function convert_class_in_scratch(){
+
+    local header=$1
+    local relative_dir=$2
+    local job_dir=$3
+    local cache_entry=$4
+
+    local name=$(basename ${header} .h)
+    local source_dir=$(dirname ${header})
+
+    mkdir -p ${job_dir}
+    cp ${header} ${job_dir}/
+
+    for companion in ${name}.cpp ${name}_inl.h;
+    do
+        if [ -e ${source_dir}/${companion} ];
+        then
+            cp ${source_dir}/${companion} ${job_dir}/
+        fi
+    done
+
+    (cd ${job_dir} && bash ${converter} "${job_options[@]}" ${name}.h) \
+        > ${job_dir}/log 2>&1
+
+    # the converter does not tell failure by exit status in all cases, so a
+    # class is treated as converted only if both files are generated.
+    local converted_file=$(cd ${job_dir} && ls *.c 2>/dev/null | \
+        grep -v "_bench\.c$" | head -1)
+    if [[ ${converted_file} == '' ]] || \
+       ! grep -q "^conversion is done." ${job_dir}/log;
+    then
+        echo "failed" > ${job_dir}/status
+        return
+    fi
+
+    mkdir -p ${output_dir}/${relative_dir}
+    local self=${converted_file%.c}
+    cp ${job_dir}/${self}.h ${job_dir}/${self}.c ${output_dir}/${relative_dir}/
+    cp ${job_dir}/${self}_bench.c* ${output_dir}/${relative_dir}/ 2>/dev/null
+
+    # the >>> ... <<< ... >>> blocks mark the bindings we can not decide.
+    if grep -q "^>>>" ${job_dir}/${self}.c ${job_dir}/${self}.h;
+    then
+        echo "ambiguous" > ${job_dir}/status
+    else
+        echo "converted" > ${job_dir}/status
+    fi
+
+    # only successful conversions are cached, the entry is filled aside and
+    # then renamed, so a interrupted run never leaves a partial entry.
+    if [[ ${cache_entry} != '' ]];
+    then
+        mkdir -p ${cache_entry}.$$
+        cp ${job_dir}/${self}.h ${job_dir}/${self}.c ${job_dir}/status \
+            ${cache_entry}.$$/
+        if [ -e ${job_dir}/${self}.layout.txt ];
+        then
+            cp ${job_dir}/${self}.layout.txt ${cache_entry}.$$/
+        fi
+        cp ${job_dir}/${self}_bench.c* ${cache_entry}.$$/ 2>/dev/null
+        mv -T ${cache_entry}.$$ ${cache_entry} 2>/dev/null || \
+            rm -rf ${cache_entry}.$$
+    fi
+}
+
+
+# the cache key of a class is the hash of the converter itself, the header,
+# the source and the inline header of the class and the cache key of its parent
+# class, so a changed parent invalidates all its children as well.
+function compute_cache_key(){
+
+    local self=$1
+
+    if [[ ${cache_key[$self]} != '' ]];
+    then
+        echo ${cache_key[$self]}
+        return
+    fi
+
+    local header=${header_of_class[$self]}
+    local parent=${parent_of_class[$self]}
+    local name=$(basename ${header} .h)
+    local source_dir=$(dirname ${header})
+
+    local parent_key=''
+    if [[ ${parent} != '' && ${header_of_class[$parent]} != '' ]];
+    then
+        parent_key=$(compute_cache_key ${parent})
+    fi
+
+    {
+        echo "converter: ${converter_version}"
+        echo "parent: ${parent} ${parent_key}"
+        if [[ ${devirtualize} == "yes" ]];
+        then
+            echo "direct calls: $(grep "^${self} " ${direct_calls_file})"
+        fi
+        echo "track configured: ${track_configured}"
+        echo "object pool: ${object_pool_size}"
+        echo "trace buffer: ${trace_buffer_size}"
+        if [[ ${class_id_casts} == "yes" ]];
+        then
+            echo "class ids: ${class_ids_version}"
+        fi
+        if [[ ${layout} == "yes" ]];
+        then
+            echo "typedefs: ${typedefs_version}"
+        fi
+        echo "attributes: ${attributes} $(grep "^${self} " ${hot_file:-/dev/null})"
+        if [[ ${prune_includes} == "yes" ]];
+        then
+            echo "prune includes: ${classes_version}"
+        fi
+        echo "instrument: ${instrument}"
+        echo "dispatch benchmark: ${dispatch_benchmark}"
+        for input in ${name}.h ${name}.cpp ${name}_inl.h;
+        do
+            echo "file: ${input}"
+            if [ -e ${source_dir}/${input} ];
+            then
+                cat ${source_dir}/${input}
+            fi
+        done
+    } | sha1sum | cut -d' ' -f1
+}
+
+
+# convert all classes of a directory tree or a list of header files, each
+# class is converted concurrently with at most ${job_limit} classes at a time.
+function convert_project(){
+
+    converter=$(readlink -f "${BASH_SOURCE[0]}")
+    scratch_root=$(mktemp -d "${TMPDIR:-/tmp}/converter.XXXXXX")
+
+    mkdir -p ${output_dir}
+    output_dir=$(readlink -f ${output_dir})
+
+    if [[ ${use_cache} == "yes" ]];
+    then
+        cache_dir=${cache_dir:-${output_dir}/.cache}
+        mkdir -p ${cache_dir}
+        cache_dir=$(readlink -f ${cache_dir})
+        converter_version=$(sha1sum < ${converter} | cut -d' ' -f1)
+    fi
+
+    # collect headers in the form of "header relative_dir", only headers
+    # declaring a class are interesting.
+    local header_list=${scratch_root}/headers
+    touch ${header_list}
+
+    for input in "$@";
+    do
+        if [ -d ${input} ];
+        then
+            (cd ${input} && find . -name "*.h" ! -name "*_inl.h" | sort) | \
+            while read header;
+            do
+                echo "${input}/${header#./} $(dirname ${header#./})"
+            done >> ${header_list}
+        elif [ -e ${input} ];
+        then
+            echo "${input} ." >> ${header_list}
+        else
+            echo "File named ${input} does't exist"
+        fi
+    done
+
+    # the class hierarchy of the project, used to invalidate the cached
+    # children of a changed parent class.
+    declare -gA header_of_class parent_of_class cache_key
+    local class_list=${scratch_root}/classes
+    touch ${class_list}
+
+    local skipped=0
+    while read header relative_dir;
+    do
+        local class_and_parent=$(extract_class_and_parent ${header})
+        local self=${class_and_parent%/*}
+        if [[ ${self} == '' ]];
+        then
+            skipped=$((skipped+1))
+            continue
+        fi
+
+        header_of_class[$self]=${header}
+        parent_of_class[$self]=${class_and_parent#*/}
+        echo "${self} ${header} ${relative_dir}" >> ${class_list}
+    done < ${header_list}
+
+    # the class hierarchy index is built once for all classes, and kept in
+    # the output directory so that a single class can be converted with it.
+    local hierarchy=${output_dir}/class_hierarchy
+    index_class_hierarchy $(cut -d' ' -f2 ${class_list}) > ${hierarchy}
+
+    # options passed to the conversion of each class, the TypeInfo of all
+    # classes are registered by the registration unit of the project.
+    job_options=(--hierarchy ${hierarchy} --export-type-info)
+
+    if [[ ${profile} == "yes" ]];
+    then
+        job_options+=(--profile)
+        local project_start=${EPOCHREALTIME/./}
+        local profile_list=${scratch_root}/profiles
+        touch ${profile_list}
+    fi
+
+    if [[ ${track_configured} == "yes" ]];
+    then
+        job_options+=(--track-configured)
+    fi
+
+    if [[ ${object_pool_size} != '' ]];
+    then
+        job_options+=(--object-pool ${object_pool_size})
+    fi
+
+    if [[ ${trace_buffer_size} != '' ]];
+    then
+        job_options+=(--trace-buffer ${trace_buffer_size})
+    fi
+
+    # the identifiers of all classes change when a class is added, so the
+    # cached classes are converted again then.
+    if [[ ${class_id_casts} == "yes" ]];
+    then
+        generate_class_ids ${hierarchy} > ${output_dir}/class_ids.h
+        class_ids_version=$(sha1sum < ${output_dir}/class_ids.h | cut -d' ' -f1)
+        job_options+=(--class-ids ${output_dir}/class_ids.h)
+    fi
+
+    if [[ ${attributes} == "yes" ]];
+    then
+        job_options+=(--attributes)
+        if [[ ${hot_file} != '' ]];
+        then
+            job_options+=(--hot ${hot_file})
+        fi
+    fi
+
+    # the includes of classes are pruned with the classes of the project, so
+    # the cached classes are converted again when a class is added.
+    if [[ ${prune_includes} == "yes" ]];
+    then
+        classes_version=$(cut -d' ' -f1 ${class_list} | sha1sum | cut -d' ' -f1)
+        job_options+=(--prune-includes)
+    fi
+
+    if [[ ${instrument} == "yes" ]];
+    then
+        job_options+=(--instrument)
+    fi
+
+    if [[ ${dispatch_benchmark} == "yes" ]];
+    then
+        job_options+=(--dispatch-benchmark)
+    fi
+
+    # the typedefs of all headers, including those declaring no class.
+    if [[ ${layout} == "yes" ]];
+    then
+        typedefs_file=${scratch_root}/typedefs
+        collect_typedefs $(cut -d' ' -f1 ${header_list}) > ${typedefs_file}
+        typedefs_version=$(sha1sum < ${typedefs_file} | cut -d' ' -f1)
+        job_options+=(--layout --typedefs ${typedefs_file})
+        rm -f ${output_dir}/layout.txt
+    fi
+
+    if [[ ${devirtualize} == "yes" ]];
+    then
+        direct_calls_file=${scratch_root}/direct_calls
+
+        find_devirtualizable_methods ${hierarchy} > ${direct_calls_file}
+        job_options+=(--direct-calls ${direct_calls_file})
+
+        # all source files of the project, where the call sites are.
+        local source_files=$(cut -d' ' -f2 ${class_list} | \
+            sed 's/\.h$//' | while read name;
+            do
+                ls ${name}.cpp ${name}_inl.h 2>/dev/null
+            done)
+
+        report_direct_call_sites ${direct_calls_file} ${hierarchy} \
+            ${source_files} > ${output_dir}/direct_calls.txt
+    fi
+
+    local job_num=0
+    while read self header relative_dir;
+    do
+        job_num=$((job_num+1))
+        echo "${header}" > ${scratch_root}/header_${job_num}
+        echo "${self}" > ${scratch_root}/class_${job_num}
+
+        local cache_entry=''
+        if [[ ${use_cache} == "yes" ]];
+        then
+            cache_key[$self]=$(compute_cache_key ${self})
+            cache_entry=${cache_dir}/${cache_key[$self]}
+
+            # unchanged class: reuse the previously converted files.
+            if [ -e ${cache_entry}/status ];
+            then
+                mkdir -p ${output_dir}/${relative_dir} \
+                    ${scratch_root}/job_${job_num}
+                cp ${cache_entry}/*.h ${cache_entry}/*.c \
+                    ${output_dir}/${relative_dir}/
+                cp ${cache_entry}/*_bench.cpp ${output_dir}/${relative_dir}/ \
+                    2>/dev/null
+                cp ${cache_entry}/*.layout.txt ${scratch_root}/job_${job_num}/ \
+                    2>/dev/null
+                echo "cached $(cat ${cache_entry}/status)" > \
+                    ${scratch_root}/job_${job_num}/status
+                continue
+            fi
+        fi
+
+        if [[ $(jobs -rp | wc -l) -ge ${job_limit} ]];
+        then
+            wait -n
+        fi
+
+        convert_class_in_scratch ${header} ${relative_dir} \
+            ${scratch_root}/job_${job_num} "${cache_entry}" < /dev/null &
+
+    done < ${class_list}
+    wait
+
+    # summary of the project conversion
+    local converted=0
+    local failed=0
+    local ambiguous=0
+    local cached=0
+    touch ${scratch_root}/converted_classes
+    for ((i=1; i<=job_num; i++));
+    do
+        job_dir=${scratch_root}/job_${i}
+        header=$(cat ${scratch_root}/header_${i})
+
+        local status=$(cat ${job_dir}/status 2>/dev/null)
+        if [[ ${status} == "cached "* ]];
+        then
+            cached=$((cached+1))
+            status=${status#cached }
+        fi
+
+        # the profile of the class, cached classes are not converted at all.
+        if [[ ${profile} == "yes" ]];
+        then
+            if ls ${job_dir}/*.profile.json >&/dev/null;
+            then
+                sed 's/^/    /' ${job_dir}/*.profile.json > ${job_dir}/profile
+            else
+                echo "    {\"header\": \"${header}\", \"cached\": true}" > ${job_dir}/profile
+            fi
+            echo ${job_dir}/profile >> ${profile_list}
+        fi
+
+        if [[ ${layout} == "yes" ]];
+        then
+            cat ${job_dir}/*.layout.txt >> ${output_dir}/layout.txt 2>/dev/null
+        fi
+
+        case "${status}" in
+            "converted")
+                converted=$((converted+1))
+                cat ${scratch_root}/class_${i} >> ${scratch_root}/converted_classes
+                ;;
+            "ambiguous")
+                converted=$((converted+1))
+                cat ${scratch_root}/class_${i} >> ${scratch_root}/converted_classes
+                ambiguous=$((ambiguous+1))
+                echo "ambiguous bindings: ${header}, please check it yourself."
+                ;;
+            *)
+                failed=$((failed+1))
+                echo "failed: ${header}, see ${job_dir}/log"
+                ;;
+        esac
+    done
+
+    # a single registration unit for all converted classes, in the order of
+    # the class hierarchy.
+    if [ -s ${scratch_root}/converted_classes ];
+    then
+        # the unit is in the output directory, it includes Qom/object.h of
+        # the project at its place in the output tree, or Qom/object.h of
+        # the output directory if the project has none.
+        local qom_dir=$(awk '$1 ~ /(^|\/)Qom\/object\.h$/ && $2 ~ /(^|\/)Qom$/ {
+                                 print $2
+                                 exit
+                             }' ${header_list})
+        local qom_header=${qom_dir:-Qom}/object.h
+
+        order_classes_by_hierarchy ${hierarchy} | \
+            grep -Fx -f ${scratch_root}/converted_classes | \
+            generate_type_registration ${qom_header} > ${output_dir}/type_registration.c
+        {
+            echo "#ifndef TYPE_REGISTRATION_H"
+            echo "#define TYPE_REGISTRATION_H"
+            echo ""
+            echo "// register the types of all converted classes."
+            echo "void register_all_types(void);"
+            echo ""
+            echo "#endif"
+        } > ${output_dir}/type_registration.h
+    fi
+
+    if [[ ${prune_includes} == "yes" ]];
+    then
+        generate_build_graph ${output_dir} ${cache_dir}
+    fi
+
+    if [[ ${profile} == "yes" ]];
+    then
+        print_project_profile_json $((${EPOCHREALTIME/./} - project_start)) \
+            ${profile_list} > ${output_dir}/profile.json
+    fi
+
+    # scratch directories of converted classes are not needed any more.
+    for ((i=1; i<=job_num; i++));
+    do
+        if grep -q "converted\|ambiguous" ${scratch_root}/job_${i}/status 2>/dev/null;
+        then
+            rm -rf ${scratch_root}/job_${i}
+        fi
+    done
+
+    echo ""
+    echo "classes converted: ${converted} (${cached} unchanged, reused from cache)"
+    echo "classes failed:    ${failed}"
+    echo "ambiguous binding: ${ambiguous}"
+    echo "headers skipped:   ${skipped} (no class declared)"
+    if [[ ${devirtualize} == "yes" ]];
+    then
+        echo "direct calls:      $(wc -l < ${direct_calls_file}) method(s)," \
+             "$(grep -c "(safe)$" ${output_dir}/direct_calls.txt) safe call" \
+             "site(s), see ${output_dir}/direct_calls.txt"
+    fi
+    echo "output directory:  ${output_dir}"
+
+    # scratch directories of failed classes are kept for inspection.
+    if [[ ${failed} -eq 0 ]];
+    then
+        rm -rf ${scratch_root}
+        return 0
+    fi
+
+    return 1
+}
+
+
+
+
+
+###############################################################################
+#
+#                             stream mode 
+#
+###############################################################################
+
+# convert a single class in a private scratch directory, in memory when
+# /dev/shm is available. the inputs are copied there under the name of the
+# class, so the header can come from stdin and the input files are never
+# renamed or rewritten; all intermediate files of the conversion stay in the
+# scratch directory, which is removed at exit.
+function convert_stream(){
+
+    local header=$1
+    local converter=$(readlink -f "${BASH_SOURCE[0]}")
+
+    # only the converted .h and .c are streamed out.
+    if [[ ${dispatch_benchmark} == "yes" ]];
+    then
+        echo "--dispatch-benchmark can not be used with --stream" >&2
+        return 1
+    fi
+
+    local scratch_base=/dev/shm
+    if [ ! -d ${scratch_base} ] || [ ! -w ${scratch_base} ];
+    then
+        scratch_base=${TMPDIR:-/tmp}
+    fi
+    scratch_dir=$(mktemp -d ${scratch_base}/converter.XXXXXX)
+    trap 'rm -rf ${scratch_dir}' EXIT
+
+    if [[ ${header} == "-" ]];
+    then
+        cat > ${scratch_dir}/input_header
+    elif [ -e ${header} ];
+    then
+        cp ${header} ${scratch_dir}/input_header
+
+        # the companions of a header file are found by its name.
+        local name=${header%.*}
+        if [[ ${stream_source} == '' && -e ${name}.cpp ]];
+        then
+            stream_source=${name}.cpp
+        fi
+        if [[ ${stream_inline} == '' && -e ${name}_inl.h ]];
+        then
+            stream_inline=${name}_inl.h
+        fi
+    else
+        echo "File named ${header} does't exist" >&2
+        return 1
+    fi
+
+    local class_and_parent=$(extract_class_and_parent ${scratch_dir}/input_header)
+    local self=${class_and_parent%/*}
+    if [[ ${self} == '' ]];
+    then
+        echo "Waring: no class in header file" >&2
+        return 1
+    fi
+
+    mv ${scratch_dir}/input_header ${scratch_dir}/${self}.h
+    if [[ ${stream_source} != '' ]];
+    then
+        cp ${stream_source} ${scratch_dir}/${self}.cpp || return 1
+    fi
+    if [[ ${stream_inline} != '' ]];
+    then
+        cp ${stream_inline} ${scratch_dir}/${self}_inl.h || return 1
+    fi
+
+    local options=()
+    if [[ ${hierarchy_file} != '' ]];
+    then
+        options+=(--hierarchy ${hierarchy_file})
+    fi
+    if [[ ${direct_calls_file} != '' ]];
+    then
+        options+=(--direct-calls ${direct_calls_file})
+    fi
+    if [[ ${profile} == "yes" ]];
+    then
+        options+=(--profile)
+    fi
+    if [[ ${track_configured} == "yes" ]];
+    then
+        options+=(--track-configured)
+    fi
+    if [[ ${object_pool_size} != '' ]];
+    then
+        options+=(--object-pool ${object_pool_size})
+    fi
+    if [[ ${trace_buffer_size} != '' ]];
+    then
+        options+=(--trace-buffer ${trace_buffer_size})
+    fi
+    if [[ ${class_ids_file} != '' ]];
+    then
+        options+=(--class-ids ${class_ids_file})
+    fi
+    if [[ ${layout} == "yes" ]];
+    then
+        options+=(--layout)
+    fi
+    if [[ ${attributes} == "yes" ]];
+    then
+        options+=(--attributes)
+    fi
+    if [[ ${prune_includes} == "yes" ]];
+    then
+        options+=(--prune-includes)
+    fi
+    if [[ ${instrument} == "yes" ]];
+    then
+        options+=(--instrument)
+    fi
+    if [[ ${hot_file} != '' ]];
+    then
+        options+=(--hot ${hot_file})
+    fi
+    if [[ ${typedefs_file} != '' ]];
+    then
+        options+=(--typedefs ${typedefs_file})
+    fi
+    if [[ ${export_type_info} == "yes" ]];
+    then
+        options+=(--export-type-info)
+    fi
+
+    # the messages of the conversion would mix with the converted files on
+    # stdout, they are shown only if the conversion fails.
+    (cd ${scratch_dir} && bash ${converter} "${options[@]}" ${self}.h) \
+        > ${scratch_dir}/log 2>&1
+
+    if [ ! -e ${scratch_dir}/${self}.c ] || \
+       ! grep -q "^conversion is done." ${scratch_dir}/log;
+    then
+        cat ${scratch_dir}/log >&2
+        return 1
+    fi
+
+    if [[ ${profile} == "yes" ]];
+    then
+        cat ${scratch_dir}/${self}.profile.json >&2
+    fi
+    if [[ ${layout} == "yes" ]];
+    then
+        cat ${scratch_dir}/${self}.layout.txt >&2
+    fi
+
+    if [[ ${stream_output_header} != '' ]];
+    then
+        cat ${scratch_dir}/${self}.h > ${stream_output_header}
+    else
+        cat ${scratch_dir}/${self}.h
+    fi
+
+    if [[ ${stream_output_source} != '' ]];
+    then
+        cat ${scratch_dir}/${self}.c > ${stream_output_source}
+    else
+        cat ${scratch_dir}/${self}.c
+    fi
+}
+
+
+if [[ ${stream} == "yes" ]];
+then
+    if [[ $# -ne 1 ]];
+    then
+        usage
+        exit 1
+    fi
+    convert_stream "$1"
+    exit $?
+fi
+
+if [[ $# -gt 1 ]] || [ -d "$1" ];
+then
+    convert_project "$@"
+    exit $?
 fi
 
 
@@ -19,6 +1880,18 @@ fi
 #
 ###############################################################################
 
+profile_phase "preprocess"
+
+# count the in-place rewrites of files when profiling.
+sed_inplace_num=0
+if [[ ${profile} == "yes" ]];
+then
+    function sed(){
+        [[ " $* " == *" -i "* ]] && sed_inplace_num=$((sed_inplace_num+1))
+        command sed "$@"
+    }
+fi
+
 #change the suffix of cplusplus header to .H
 cplusplus_header=$1
 prefix=${cplusplus_header%.*}
@@ -51,9 +1924,6 @@ fi
 
 sed 's/^[\t ]\+//g' ${cplusplus_header} > formatted_file 
 
-# escape all double quotes to prevent unterminal string error in awk
-sed -i 's/"/\\"/g' formatted_file 
-
 # insert void to () in a function header which takes no arguments, but in order
 # consistent process later, doing so is deserved.
 sed -i 's/()/(void)/g' formatted_file 
@@ -84,25 +1954,7 @@ sed -i 's/\([a-zA-Z_]\+\) *(/\1(/g' formatted_file
 ### extract the class itself name and parent name if exist
 ###
 
-# for the cplusplus souce file only has single inheritance, and the qemu object
-# model only support single inheritance in this way (multi inheritance can be
-# do by using interfaces in qemu), we here just tackle this case.
-awk_stdout=$(awk '
-   # the class has parent
-   /^class/ && /\:/{
-     gsub(/(class|\:|public|protected|\{)/, " ")
-     split($0, ary, " ")
-     print ary[1]"/"ary[2]
-     exit 0 
-   }
-   # the class has no parent
-   /^class/ {
-     gsub(/(class|\:|public|protected|\{)/, "")
-     split($0, ary, " ")
-     print ary[1]"/"
-     exit 0
-   }
- ' formatted_file)
+awk_stdout=$(extract_class_and_parent formatted_file)
 
 self=${awk_stdout%/*}
 if [[ ${#self} == 0 ]];
@@ -128,35 +1980,123 @@ lowercase_self=$(echo $self | tr 'A-Z' 'a-z')
 
 
 
+###
+### resolve the owner of virtual methods with the class hierarchy index
+###
+
+# the owner of a virtual method is the class whose class struct has the
+# function pointer: the topmost class declaring it.
+declare -A virtual_owner
+hierarchy_complete="no"
+
+if [[ ${parent} == "Object" ]];
+then
+    hierarchy_complete="yes"
+elif [[ ${hierarchy_file} != '' ]];
+then
+    while read func_name owner;
+    do
+        if [[ ${func_name} == "-" ]];
+        then
+            hierarchy_complete=${owner}
+        else
+            virtual_owner[$func_name]=${owner}
+        fi
+    done < <(resolve_ancestor_virtuals ${hierarchy_file} ${parent})
+fi
+
+# print the owner of a virtual method, empty if we can not decide.
+function virtual_owner_of(){
+    if [[ ${virtual_owner[$1]} != '' ]];
+    then
+        echo ${virtual_owner[$1]}
+    elif [[ ${hierarchy_complete} == "yes" ]];
+    then
+        echo ${self}
+    fi
+}
+
+
+
+
+
+###
+### decide the configured state tracking
+###
+
+# with --track-configured, the root class keeps the configured state of all
+# objects in the system list, and the set* methods of the root class and its
+# descendants mark the objects whose state has to be checked again.
+configured_root=CC_RootObject
+tracks_configured="no"
+
+if [[ ${track_configured} == "yes" ]];
+then
+    if [[ ${self} == ${configured_root} || ${parent} == ${configured_root} ]];
+    then
+        tracks_configured="yes"
+    elif [[ ${hierarchy_file} != '' ]];
+    then
+        tracks_configured=$(is_derived_from ${hierarchy_file} ${self} \
+                            ${configured_root})
+    fi
+fi
+
+
+
+
+
+###
+### decide the class identifier casts
+###
+
+# only the classes numbered in the class identifiers file use them.
+uses_class_ids="no"
+if [[ ${class_ids_file} != '' ]] && \
+   grep -q "^#define TYPE_ID_${uppercase_self} " ${class_ids_file};
+then
+    uses_class_ids="yes"
+fi
+
+
+
+
 ###
 ### extract parts to corresponding files for later use
 ###
 
-touch hfile ovfile cvfile cffile pvffile vffile omfile cfile cmfile ccmfile \
+profile_phase "extraction"
+
+touch hfile ovfile cvfile cffile pvffile vffile omfile cfile ccmfile \
     omdfile cfdfile pvfdfile vfdfile fnsfile smfile
 
 awk '
 
  function clear_comments() {
-    system("rm "  comments  " && "  "touch " comments);
+    comments_num = 0;
+ }
+
+ # comments are buffered in memory, "comments_num" is the number of lines.
+ function add_comments(line) {
+    comments_buf[++comments_num] = line;
  }
 
  #TODO data mutiline comments should be with indentation
  function write_comments_to(file_to_write, is_multiline_comment, need_indentation){
 
-    if (system("test -s "  comments) == 0){
+    if (comments_num > 0){
         
         leading = need_indentation==1 ? "    " : ""
 
         if (is_multiline_comment) {
-            system("echo " "\"" leading "\""  "\/\**"  " >> " file_to_write );
+            print leading "/**" > file_to_write;
 
-            system("cat "  comments  " >> "  file_to_write);
+            for (i = 1; i <= comments_num; i++) print comments_buf[i] > file_to_write;
 
             # "*/" should has one space indentation
-            system("echo " "\"" leading "\""  "\" "  "*/"  "\" " " >> "  file_to_write);
+            print leading " */" > file_to_write;
         } else {
-            system("cat "  comments  " >> "  file_to_write);
+            for (i = 1; i <= comments_num; i++) print comments_buf[i] > file_to_write;
         }
 
         clear_comments();
@@ -184,6 +2124,9 @@ awk '
     # comment style
     is_multiline_comment = 0;
 
+    # number of buffered comment lines
+    comments_num = 0;
+
     # private is defalut, private:0, protected:1, public:2.
     access_control = 0;
  }
@@ -191,10 +2134,10 @@ awk '
  # extract comments // style
  /^\/\//{
     if (comment_for_copyright != 1) {
-        system("echo " "\""  $0  "\"" " >> " comments);
+        add_comments($0);
         is_multiline_comment = 0;
     } else {
-        system("echo " "\""  $0  "\"" " >> " copyright);
+        print $0 > copyright;
     }
 
     next
@@ -202,7 +2145,7 @@ awk '
 
  # sigle-line /**/ style comment
  /^\/\*/ && /\*\//{
-    system("echo " "\""  $0  "\"" " >> " comments);
+    add_comments($0);
     is_multiline_comment = 0;
     next
  }
@@ -218,9 +2161,9 @@ awk '
     if (comment_for_class != 1) {
       # here comments file serves as temprary file holding comments which
       # will be tackled immediately atfer.
-      system("echo " "\" " $0  "\"" " >> " comments);
+      add_comments(" " $0);
     } else {
-      system("echo " "\" "  $0  "\"" " >> " class_comments);
+      print " " $0 > class_comments;
     }
     next
  }
@@ -239,7 +2182,7 @@ awk '
 
  # extract header 
  /\#include/{
-    system("echo " "\""  $0  "\"" " >> " includes);
+    print $0 > includes;
     comment_for_copyright = 0;
     next
  }
@@ -253,11 +2196,11 @@ awk '
  !/static/ && /[a-zA-Z_0-9]+ \**[a-zA-Z_0-9\[\]]+;/{
 
     #comments for object variable alse need 4 spaces long indentation
-    system ("sed -i " "\"" "s/^/    /" "\" " comments);
+    for (i = 1; i <= comments_num; i++) comments_buf[i] = "    " comments_buf[i];
     write_comments_to(object_variables, is_multiline_comment, 1);
 
     # with 4 spaces indentation
-    system("echo " "\"    "  $0  "\"" " >> " object_variables);
+    print "    " $0 > object_variables;
     next
  }
 
@@ -269,10 +2212,10 @@ awk '
 
     ac = get_access_constrol_description(access_control);
 
-    system("echo " "\"" ac  "\" "  "\""  $0  "\""  " >> " class_variables);
+    print ac " " $0 > class_variables;
 
     # add a blank line between two class variable decalration
-    system("echo " " >> " class_variables);
+    print "" > class_variables;
 
     next 
  }
@@ -284,12 +2227,12 @@ awk '
 
     ac = get_access_constrol_description(access_control);
 
-    system("echo " "\"" ac  "\" "  "\""  $0  "\""  " >> " class_funcs);
-    system("echo " " >> " class_funcs);
+    print ac " " $0 > class_funcs;
+    print "" > class_funcs;
 
     write_comments_to(class_funcs_decl, is_multiline_comment);
-    system("echo " "\"" ac  "\" "  "\""  $0  "\""  " >> " class_funcs_decl);
-    system("echo "  " >> " class_funcs_decl);
+    print ac " " $0 > class_funcs_decl;
+    print "" > class_funcs_decl;
 
     next
  }
@@ -298,11 +2241,11 @@ awk '
  /virtual/ && /=/{
     virtual_func_num++;
 
-    system("echo " "\"    "  $0  "\"" " >> " pure_virtual_funcs);
+    print "    " $0 > pure_virtual_funcs;
 
     write_comments_to(pure_virtual_funcs_decl, is_multiline_comment);
-    system("echo " "\"    "  $0  "\"" " >> " pure_virtual_funcs_decl);
-    system("echo " " >> " pure_virtual_funcs_decl);
+    print "    " $0 > pure_virtual_funcs_decl;
+    print "" > pure_virtual_funcs_decl;
 
     next
  }
@@ -311,11 +2254,11 @@ awk '
  /virtual/{
     virtual_func_num++;
 
-    system("echo " "\"    "  $0  "\"" " >> " virtual_funcs);
+    print "    " $0 > virtual_funcs;
 
     write_comments_to(virtual_funcs_decl, is_multiline_comment);
-    system("echo " "\"    "  $0  "\"" " >> " virtual_funcs_decl);
-    system("echo " " >> " virtual_funcs_decl);
+    print "    " $0 > virtual_funcs_decl;
+    print "" > virtual_funcs_decl;
 
     next
  }
@@ -327,12 +2270,12 @@ awk '
 
     ac = get_access_constrol_description(access_control);
 
-    system("echo " "\"" ac  "\" "  "\""  $0  "\""  " >> " object_methods);
-    system("echo " " >> " object_methods);
+    print ac " " $0 > object_methods;
+    print "" > object_methods;
 
     write_comments_to(object_methods_decl, is_multiline_comment);
-    system("echo " "\"" ac  "\" "  "\""  $0  "\""  " >> " object_methods_decl);
-    system("echo " " >> " object_methods_decl);
+    print ac " " $0 > object_methods_decl;
+    print "" > object_methods_decl;
 
     next
   }
@@ -341,7 +2284,7 @@ awk '
   # constructor and so on.
   # "^[^a-zA-Z_]*${self}", if self is "TestSuite", then runTestSuite do not match.
   /[a-zA-Z_] *\(/ && $0 ~ class_pattern{
-      system("echo " "\""  $0  "\"" " >> " special_methods);
+      print $0 > special_methods;
   }
 
  # private access control
@@ -367,14 +2310,14 @@ awk '
   }
 
   END{
-     system("echo V_FUNCTION_NUMBER=" virtual_func_num " >> " func_num_statics);
-     system("echo O_METHOD_NUMBER=" object_method_num " >> " func_num_statics);
-     system("echo C_FUNCTION_NUMBER=" class_func_num " >> " func_num_statics);
+     print "V_FUNCTION_NUMBER=" virtual_func_num > func_num_statics;
+     print "O_METHOD_NUMBER=" object_method_num > func_num_statics;
+     print "C_FUNCTION_NUMBER=" class_func_num > func_num_statics;
   }
 
 ' includes=hfile object_variables=ovfile  class_funcs=cffile \
   virtual_funcs=vffile class_variables=cvfile object_methods=omfile \
-  copyright=cfile comments=cmfile class_comments=ccmfile \
+  copyright=cfile class_comments=ccmfile \
   class_funcs_decl=cfdfile virtual_funcs_decl=vfdfile \
   object_methods_decl=omdfile func_num_statics=fnsfile\
   pure_virtual_funcs_decl=pvfdfile pure_virtual_funcs=pvffile\
@@ -390,12 +2333,73 @@ rm -f formatted_file
 
 
 
+###
+### mark inline methods
+###
+
+# methods defined in ${self}_inl.h are inline even if they are not declared
+# with inline keyword in the header, so we add the missing keyword to them;
+# all inline methods are emitted as static inline functions in ${self}.h.
+touch ilfile ilifile
+if [ -e ${self}_inl.h ];
+then
+    # the inline bodies need the includes of ${self}_inl.h, such as assert
+    # and pNULL, so they are kept for ${self}.h.
+    tr -d '\r' < ${self}_inl.h | grep "^#include" | \
+        grep -v "[\"/]${self}\.h\"" > ilifile
+
+    index_function_bodies ${self}_inl.h | \
+        sed -n "s/^${self}::\([a-zA-Z_][a-zA-Z_0-9]*\) .*/\1/p" > ilist
+
+    while read func_name;
+    do
+        sed -i \
+            "/inline/!s/^\([a-z]\+\) static \(.*[ \*]${func_name}(\)/\1 inline static \2/" \
+            cffile cfdfile
+        sed -i \
+            "/inline/!s/^\([a-z]\+\) \(.*[ \*]${func_name}(\)/\1 inline \2/" \
+            omfile omdfile
+    done < ilist
+fi
+
+# the static inline methods are emitted in ${self}.h, where the class data,
+# defined in ${self}.c, can not be seen; so the inline methods using class
+# data are kept out of line.
+sed -n 's/^[a-z]\+ [^=;(]*[ *]\([a-zA-Z_][a-zA-Z_0-9]*\) *\(\[.*\]\)\? *\(=.*\)\?;.*/\1/p' \
+    cvfile > cdnlist
+inline_names=$(sed -n 's/^[a-z]\+ \(.* \)\?inline .*[ *]\([a-zA-Z_][a-zA-Z_0-9]*\)(.*/\2/p' \
+    cffile omfile)
+if [ -s cdnlist ] && [[ ${inline_names} != '' ]];
+then
+    cat $(ls ${self}_inl.h ${self}.cpp 2>/dev/null) /dev/null > ibsfile
+    index_function_bodies ibsfile ibnfile > ibfile
+
+    for func_name in ${inline_names};
+    do
+        range=$(awk '$1 == key { print $2 "," $3 }' key="${self}::${func_name}" ibfile)
+        if [[ ${range} != '' ]] && \
+           sed -n "${range}p" ibnfile | grep -qw -f cdnlist;
+        then
+            sed -i \
+                "s/^\([a-z]\+ \(.* \)\?\)inline \(.*[ *]${func_name}(\)/\1\3/" \
+                cffile cfdfile omfile omdfile
+        fi
+    done
+    unset range
+fi
+
+
+
+
+
 ###############################################################################
 #
 #                             generate .h file
 #
 ###############################################################################
 
+profile_phase "header"
+
 # example: function(para1,  para2,para3)-->function(para1, para2, para3)
 function format_function_parameter_list(){
     sed -i \
@@ -441,6 +2445,10 @@ echo -e "\n"
 ###
 cat hfile
 echo "#include \"../Qom/object.h\""
+if [[ ${uses_class_ids} == "yes" ]];
+then
+    echo "#include \"class_ids.h\""
+fi
 
 
 
@@ -475,6 +2483,33 @@ echo "//                            class and struct"
 echo "//"
 echo "///////////////////////////////////////////////////////////////////////////////"
 echo ""
+# the object fields are reordered by the layout pass, the fields of the
+# parent struct are not known, so the report is for the fields of this class.
+if [[ ${layout} == "yes" ]];
+then
+    rm -f ${self}.layout.txt
+    touch ${self}.layout.txt
+
+    if [ -s ovfile ];
+    then
+        layout_fields ${self} ovfile lrfile "${typedefs_file}" \
+            $(ls ${self}.cpp ${self}_inl.h 2>/dev/null) > lofile
+        mv lofile ovfile
+        cat lrfile >> ${self}.layout.txt
+    fi
+fi
+
+# with the includes pruned, the headers declare the struct types of the
+# classes they use only by pointer, so all of them are guarded.
+if [[ ${prune_includes} == "yes" ]];
+then
+    echo "#ifndef ${uppercase_self}_TYPEDEF"
+    echo "#define ${uppercase_self}_TYPEDEF"
+    echo "typedef struct ${self} ${self};"
+    echo "#endif"
+    echo ""
+fi
+
 echo "struct $self {"
 echo "    $parent parent;"
 if [ -s ovfile ];
@@ -515,31 +2550,68 @@ sed -i 's/virtual \+//g' vffile pvffile
 
 echo "struct $self_class {"
 echo "    $parent_class parent_class;"
+if [[ ${uses_class_ids} == "yes" && ${parent} == "Object" ]];
+then
+    echo "    unsigned int type_id;"
+fi
 
 
 # for non-pure virtual function, we often have no idea about whether it is
 # in parent class or in self class; but if we know the parent is class, we 
-# can sure that the virtual function should defined in self class.
+# can sure that the virtual function should defined in self class. with the
+# class hierarchy index, the virtual functions overriding the ones of ancestors
+# are left out, for they are already in the class struct of the ancestors.
+function split_virtual_function_by_owner(){
+    rm -f $1_self $1_unknown
+    touch $1_self $1_unknown
+
+    while IFS= read -r func_line;
+    do
+        func_name=$(sed 's/.*(\*\([a-zA-Z_]\+\)).*/\1/' <<< "${func_line}")
+        owner=$(virtual_owner_of ${func_name})
+
+        if [[ ${owner} == ${self} ]];
+        then
+            echo "${func_line}" >> $1_self
+        elif [[ ${owner} == '' ]];
+        then
+            echo "${func_line}" >> $1_unknown
+        fi
+    done < $1
+}
+
 if [ -s vffile ];
 then
-    echo " "
-    
-    if [ ${parent} == "Object" ];
+    split_virtual_function_by_owner vffile
+
+    if [ -s vffile_self ] || [ -s vffile_unknown ];
+    then
+        echo " "
+    fi
+
+    cat vffile_self
+
+    if [ -s vffile_unknown ];
     then
-        cat vffile
-    else
         echo ">>> // some function may not be in here, please check youself."
-        cat vffile
+        cat vffile_unknown
         echo "<<<"
     fi
 fi
 
 if [ -s pvffile ];
 then
-    echo " "
-    cat pvffile
-    echo " "
+    split_virtual_function_by_owner pvffile
+
+    # pure virtual function is in self class if we can not decide.
+    if [ -s pvffile_self ] || [ -s pvffile_unknown ];
+    then
+        echo " "
+        cat pvffile_self pvffile_unknown
+        echo " "
+    fi
 fi
+rm -f vffile_self vffile_unknown pvffile_self pvffile_unknown
 echo "};"
 
 
@@ -552,15 +2624,28 @@ echo "};"
 
 echo -e "\n"
 
-echo "#define ${uppercase_self}_GET_CLASS(obj) \\
+if [[ ${uses_class_ids} == "yes" ]];
+then
+    echo "#define ${uppercase_self}_GET_CLASS(obj) \\
+        ${uppercase_self}_CLASS(((Object*)(obj))->class)"
+    echo ""
+    echo "#define ${uppercase_self}_CLASS(klass) \\
+        ((${self_class}*)TYPE_ID_CHECK_CLASS(klass, TYPE_ID_${uppercase_self}))"
+
+    echo ""
+    echo "#define ${uppercase_self}(obj) \\
+        ((${self}*)TYPE_ID_CHECK(obj, TYPE_ID_${uppercase_self}))"
+else
+    echo "#define ${uppercase_self}_GET_CLASS(obj) \\
         OBJECT_GET_CLASS(${self_class}, obj, TYPE_${uppercase_self})" 
-echo ""
-echo "#define ${uppercase_self}_CLASS(klass) \\
+    echo ""
+    echo "#define ${uppercase_self}_CLASS(klass) \\
         OBJECT_CLASS_CHECK(${self_class}, klass, TYPE_${uppercase_self})"
 
-echo ""
-echo "#define ${uppercase_self}(obj) \\
+    echo ""
+    echo "#define ${uppercase_self}(obj) \\
         OBJECT_CHECK(${self}, obj, TYPE_${uppercase_self})"
+fi
 
 
 
@@ -597,6 +2682,18 @@ fi
 echo -e "\n"
 echo "${self}* ${self}_new(${para_list:-void});"
 
+# add class-specific init function for objects embedded by value, abstract
+# classes have no instances.
+if [ ! -s pvffile ];
+then
+    echo ""
+    echo "// initialize an object in the storage given by the caller, e.g. a member"
+    echo "// of another struct or a static variable set to ${uppercase_self}_INITIALIZER."
+    echo "void ${self}_init(${self} *storage${para_list:+, ${para_list}});"
+    echo ""
+    echo "#define ${uppercase_self}_INITIALIZER { 0 }"
+fi
+
 
 
 
@@ -620,6 +2717,7 @@ then
        -e 's/protected \(.*\)/\1/g' \
        -e 's/public static \(.*\)/\1/g' \
        -e 's/public inline static \(.*\)/inline \1/g'\
+       -e 's/^inline \(.*\)/static inline \1/g'\
        -e "s/\([a-zA-Z_]\+\)(/${self}_\1(/g" cfdfile cffile
 
        format_function_parameter_list cffile
@@ -632,6 +2730,71 @@ fi
 
 
 
+###
+###  configured state tracking declaration
+###
+if [[ ${tracks_configured} == "yes" && ${self} == ${configured_root} ]];
+then
+   echo -e "\n"
+   echo "///////////////////////////////////////////////////////////////////////////////"
+   echo "//"
+   echo "//                   configured state tracking declaration"
+   echo "//"
+   echo "///////////////////////////////////////////////////////////////////////////////"
+   echo ""
+   echo "// check all objects in the system list, as isSystemConfigured did without"
+   echo "// the configured state tracking."
+   echo "bool ${self}_isSystemConfiguredScan(void);"
+   echo ""
+   echo "// the configured state of the object is checked again by the next"
+   echo "// isSystemConfigured, the set* methods call it for their object."
+   echo "void ${self}_markUnchecked(void *obj);"
+   echo ""
+   echo "// the configured state of all objects are checked again by the next"
+   echo "// isSystemConfigured, the static set* methods call it."
+   echo "void ${self}_markAllUnchecked(void);"
+   echo ""
+   echo "// allocate the configured state of the objects in the system list, the"
+   echo "// full scan is used if it can not be allocated."
+   echo "void ${self}_allocateObjectState(void);"
+fi
+
+
+
+
+###
+###  trace buffer declaration
+###
+
+# the class with the trace services of the framework buffers the trace items.
+buffers_trace="no"
+if [[ ${trace_buffer_size} != '' ]] && \
+   grep -q "^void ${self}_synchTrace(TD_TraceItem [a-zA-Z_]\+);" cfdfile && \
+   grep -q "^void ${self}_packetTrace(unsigned int [a-zA-Z_]\+, TD_TraceItem [a-zA-Z_]\+\[\]);" cfdfile;
+then
+   buffers_trace="yes"
+
+   echo -e "\n"
+   echo "///////////////////////////////////////////////////////////////////////////////"
+   echo "//"
+   echo "//                        trace buffer declaration"
+   echo "//"
+   echo "///////////////////////////////////////////////////////////////////////////////"
+   echo ""
+   echo "// send the buffered trace items to the tracer as packet traces."
+   echo "void ${self}_flushTrace(void);"
+   echo ""
+   echo "// the largest number of trace items buffered at the same time so far."
+   echo "unsigned int ${self}_getTraceHighWater(void);"
+   echo ""
+   echo "// send a trace item or a packet to the tracer without buffering."
+   echo "void ${self}_synchTraceUnbuffered(TD_TraceItem traceId);"
+   echo "void ${self}_packetTraceUnbuffered(unsigned int n, TD_TraceItem traceData[]);"
+fi
+
+
+
+
 ###
 ###  process non-virtual member methods declaration
 ###
@@ -650,6 +2813,7 @@ then
        -e 's/protected \(.*\)/\1/g' \
        -e 's/public \(.*\)/\1/g' \
        -e 's/public inline \(.*\)/inline \1/g'\
+       -e 's/^inline \(.*\)/static inline \1/g'\
        -e "s/\([a-zA-Z_]\+\)(/${self}_\1(/g" omdfile omfile
 
    # after concatenate class name with method name, the whole name may contain number
@@ -674,8 +2838,8 @@ fi
 ###  postprocess for ${self}.h file
 ###
 
-echo  ""
-echo "#endif"
+# the "#endif" is emitted after the static inline methods, which are known
+# only after the function bodies are extracted.
 dos2unix  ${c_header} >&/dev/null
 exec 1>&${saved_stdout}
 
@@ -691,6 +2855,8 @@ dos2unix  *dfile >&/dev/null
 #
 ###############################################################################
 
+profile_phase "source_prologue"
+
 function produce_function_header(){
 
     if [ $# -lt 1 ];
@@ -811,7 +2977,7 @@ awk '
   }
   
   {
-     system("echo " "\""  $0  "\"" " >> " source_file_header_part);
+     print $0 > source_file_header_part;
   }
 
 ' class_name=${self} source_file_header_part=shfile $cplusplus_source_file 
@@ -821,10 +2987,6 @@ awk '
 # doing the following convertion
 dos2unix shfile>&/dev/null
 
-# add double quotes for included file, for process above the double quotes lost;
-# but included file enclosed by <> don't need.
-sed -i 's/\(#include\) \+\([^\<]\+\)/\1 \"\2\"/g' shfile
-
 # update file name in copyright information 
 sed -i "s/${self}.cpp/${self}.c/g" shfile
 
@@ -915,23 +3077,79 @@ then
     echo "///////////////////////////////////////////////////////////////////////////////"
     echo ""
 
-    cat cvfile
+    # the layout pass gathers the file-static class data into one struct
+    # aligned to a cache line. constants are left out to keep them constant
+    # expressions, and so are the public and protected class data, which are
+    # globals referenced by other units.
+    if [[ ${layout} == "yes" ]] && grep "^static " cvfile | grep -v "^static const " > cdvfile;
+    then
+        grep -vxF -f cdvfile cvfile | grep -v "^[[:space:]]*$" > cdcfile
+        if [ -s cdcfile ];
+        then
+            cat cdcfile
+            echo ""
+        fi
+
+        rm -f cdifile
+        touch cdifile
+        init_file=cdifile layout_fields "${self} class data" cdvfile lrfile \
+            "${typedefs_file}" mixed_file > cdlfile
+        cat lrfile >> ${self}.layout.txt
+        class_data_names=$(sed -n 's/^    order: *//p' lrfile)
+
+        echo "#if defined(__GNUC__)"
+        echo "#define CLASS_DATA_ALIGNED __attribute__((aligned(64)))"
+        echo "#else"
+        echo "#define CLASS_DATA_ALIGNED"
+        echo "#endif"
+        echo ""
+        echo "// the class data are gathered in one struct, so they share cache lines."
+        echo "static struct {"
+        cat cdlfile
+        if [ -s cdifile ];
+        then
+            echo "} class_data CLASS_DATA_ALIGNED = {"
+            cat cdifile
+            echo "};"
+        else
+            echo "} class_data CLASS_DATA_ALIGNED;"
+        fi
+    else
+        cat cvfile
+    fi
 fi
 
 
-function construct_pattern(){
+function construct_key(){
    if [ $# -lt 2 ];
    then
-       echo "construct_pattern need two parameters"
+       echo "construct_key need two parameters"
        exit 1
    fi 
 
-   # return constructed pattern
-   echo "$1::$2 *\("
+   # return constructed key of the body index
+   echo "$1::$2"
+}
+
+
+# build the index of all function bodies in mixed_file, function bodies are
+# looked up in it later instead of scanning mixed_file for each function.
+function build_function_body_index(){
+
+   index_function_bodies mixed_file nmfile > fbifile
+   mv nmfile mixed_file
+
+   unset body_index
+   declare -gA body_index
+
+   while read key body_start body_end;
+   do
+       body_index[$key]="${body_start},${body_end}"
+   done < fbifile
 }
 
 
-# extact function body of a given name function
+# extact function body of a given key (class::func_name) from the body index
 function extract_function_body(){
 
    if [ $# -lt 1 ];
@@ -945,58 +3163,34 @@ function extract_function_body(){
    rm -f fbfile
    touch fbfile
 
-   # the main idea is finding the function which matchs a pattern first, then 
-   # we tag the start and end line number of the body in the func_body file,
-   # after that we can get a range which indicate the location of the function
-   # body we want extract.
-   range=$(awk '
-      BEGIN{
-          is_function_body = 0;
-          body_start = 0;
-          body_end = 0;
-      }
-
-      /^\/\//{
-           next 
-      }
-
-      # find the function 
-      $0~pattern{ 
-          body_start= NR + 1;
-          is_function_body = 1; 
-          next
-      }
+   body_index_lookups=$((body_index_lookups+1))
+   range=${body_index[$1]:-0,0}
+   body_start=${range%,*}
+   body_end=${range#*,}
+     
+   echo "$body_start / $body_end $1">> range
+   if [ $body_start != 0 ];
+   then
+       echo "{" > fbfile
+       if [[ ${instrument} == "yes" ]];
+       then
+           echo "    METHOD_PROFILE_ENTER($(wc -l < pnfile));" >> fbfile
+           echo "$1" >> pnfile
+       fi
+       # using this method, we can preserve special characters in line.
+       sed -n "${body_start},${body_end}p" mixed_file >> fbfile
+   fi
 
-      # assume the end of function "}" is at the begin of line, this can be
-      # guaranteed in preprocess phase or we can do ourselves.
-      /^\}/{
-          if (is_function_body == 0){
-              next
-          }else{ 
-              body_end = NR
-              exit 0
-          }
-       }
+   unset range
+}
 
-      END{
-          print body_start, "/", body_end 
-      }
+profile_phase "body_index"
+body_index_lookups=0
+build_function_body_index
 
-     ' pattern="$1" mixed_file)
-     
-     body_start=${range% /*}
-     body_end=${range#*/ }
-     
-     echo "$range $1">> range
-     if [ $body_start != 0 ];
-     then
-         echo "{" > fbfile
-         # using this method, we can preserve special characters in line.
-         sed -n "${body_start},${body_end}p" mixed_file >> fbfile
-     fi
-
-     unset range
-}
+# the keys of the instrumented methods, in the order of the profile table.
+rm -f pnfile
+touch pnfile
 
 
 function is_duplicate(){
@@ -1033,6 +3227,8 @@ function is_duplicate(){
 ### process non-virtual function 
 ### 
 
+profile_phase "non_virtual_methods"
+
 function generate_name_list_for_non_virtual_function(){
 
     # generate a list of class function name prefixed without ${self}_
@@ -1045,63 +3241,130 @@ function append_function_body_to(){
     if [ $# -lt 2 ];
     then
         echo "need two args:$1 for a list of function name and  $2 for a file"
-        echo "including function declarations."
+        echo "including function declarations, the optional $3 is a file for"
+        echo "static inline functions."
         exit 1
     fi
 
-    # for better understanding, we rename $1 and $2
+    # for better understanding, we rename $1, $2 and $3
     func_list_file=$1
     func_decl_file=$2 
+    inline_func_file=$3
+
+    mapfile -t func_names < ${func_list_file}
+    body_index_lookups=$((body_index_lookups + ${#func_names[@]}))
+
+    # all declarations are merged with their function bodies in a single pass:
+    # first the line where each function is declared (insert location) is
+    # found, then ${func_decl_file} is streamed with the body looked up in the
+    # body index appended after each declaration.
+    # Waring: to prevent partially match of function name, only several'_' or 
+    # ' ' are allowed. and we must make sure the match not taken place in the
+    # comments, so the declaration should start with a identifier.
+    # if the regex expression is not comprehensive, a function will have more
+    # than one insert location, we print them and come back to revise the
+    # regex expression.
+    # static inline function is moved with its body to ${inline_func_file}
+    # and removed from ${func_decl_file} with the blank line following it.
+    insert_location=$(awk '
+      function print_body(key, file){
+          if (key in body_range) {
+              split(body_range[key], range, ",")
+              print "{" > file
+              # the static inline methods are in the header, which can not
+              # see the profile table of the class.
+              if (instrument == "yes" && file == merged_file) {
+                  print "    METHOD_PROFILE_ENTER(" profile_num++ ");" > file
+                  print key >> profile_names
+              }
+              # using this method, we can preserve special characters in line.
+              for (k = range[1]; k <= range[2]; k++) print source[k] > file
+          } else {
+              print "{\n    // this is automate genenrated by converter\n}" > file
+          }
+      }
 
-    while read func_name_line;
-    do
-        # pattern may contains spaces, so it is necessary to protect it with 
-        # double quotes.
-        extract_function_body "$(construct_pattern ${self} ${func_name_line})"
+      FILENAME == body_index_file {
+          body_range[$1] = $2 "," $3
+          next
+      }
 
-        if [ ! -s fbfile ];
-        then
-            echo -e "{\n    // this is automate genenrated by converter\n}" > fbfile
-        fi
+      FILENAME == source_file {
+          source[FNR] = $0
+          next
+      }
 
-        # get the line number where line matchs the function name.
-        # until now, xxdfile may contains some function body already appended,
-        # so we must make sure that the substitution not taken place in both 
-        # the comments and the function body, where a function will be matched. 
-        # Waring: to prevent partially match of function name, only several'_' or 
-        # ' ' are allowed.
-        insert_location=$(sed -n "/^[a-zA-Z_][a-zA-Z_\* ]\+[_ ]\+$func_name_line(/=" ${func_decl_file})
-        
-        # if the above regex expression is not comprehensive, the insert_location
-        # will contain multiple number separated by newline; we should detect it
-        # and come back to revise the regex expression.
-        # by the way if a variable contains newline, like var="1\n2\n", we can 
-        # use [[ $var == *'\n'* ]] to check.
-        if [[ ${insert_location} == *$'\n'* ]];
-        then
-             exec 1>&${saved_stdout}
-             echo "ambiguous insert_location in ${func_decl_file}:"
-             echo "${insert_location}"
-
-             cat ${func_decl_file} > debug_info
-             rm -f *list *file
-             mv debug_info ${func_decl_file}
-
-             exit 1;
-        fi 
-
-        # save the upper part of ${func_decl_file}
-        sed -n "1,${insert_location}p" ${func_decl_file} > upper_part
-        # save the lower part of ${func_decl_file}
-        sed -n "$((insert_location+1)),\$p" ${func_decl_file} > lower_part
-        # concatenate the content of fbfile and lower_part respectively 
-        cat fbfile lower_part >> upper_part
-        # let upper_part be new ${func_decl_file}
-        mv upper_part ${func_decl_file}
-        
-    done < ${func_list_file}
+      FILENAME == func_list_file {
+          func_names[++func_num] = $1
+          next
+      }
+
+      {
+          decl[++decl_num] = $0
+      }
+
+      END {
+          for (i = 1; i <= func_num; i++) {
+              func_name = func_names[i]
+              pattern = "^[a-zA-Z_][a-zA-Z_* ]+[_ ]+" func_name "\\("
+
+              locations = ""
+              for (j = 1; j <= decl_num; j++) {
+                  if (index(decl[j], func_name "(") && decl[j] ~ pattern) {
+                      locations = locations == "" ? j : locations "\n" j
+                      location = j
+                  }
+              }
+
+              if (locations ~ /\n/) {
+                  print locations
+                  exit 1
+              }
+
+              if (locations != "") owner[location] = func_name
+          }
 
-    rm -f lower_part
+          for (j = 1; j <= decl_num; j++) {
+              if (!(j in owner)) {
+                  print decl[j] > merged_file
+                  continue
+              }
+
+              key = class_name "::" owner[j]
+
+              if (inline_file != "" && decl[j] ~ /^static inline /) {
+                  print decl[j] >> inline_file
+                  print_body(key, inline_file)
+                  print "" >> inline_file
+
+                  if (j < decl_num && decl[j + 1] == "" && !((j + 1) in owner)) j++
+                  continue
+              }
+
+              print decl[j] > merged_file
+              print_body(key, merged_file)
+          }
+      }
+    ' class_name=${self} body_index_file=fbifile source_file=mixed_file \
+      func_list_file=${func_list_file} inline_file=${inline_func_file} \
+      instrument=${instrument} profile_names=pnfile profile_num=$(wc -l < pnfile) \
+      merged_file=mgfile fbifile mixed_file ${func_list_file} ${func_decl_file})
+
+    if [[ $? -ne 0 ]];
+    then
+         exec 1>&${saved_stdout}
+         echo "ambiguous insert_location in ${func_decl_file}:"
+         echo "${insert_location}"
+
+         cat ${func_decl_file} > debug_info
+         rm -f *list *file
+         mv debug_info ${func_decl_file}
+
+         exit 1;
+    fi 
+
+    touch mgfile
+    mv mgfile ${func_decl_file}
 }
 
 
@@ -1117,7 +3380,140 @@ function process_non_virtual_method(){
     # function_header(); ---> function_header()
     sed -i 's/;//g' $1file
 
-    append_function_body_to $1list  $1file
+    append_function_body_to $1list  $1file ilfile
+}
+
+
+# insert the statement $2 at the begining of the body of each set* method in
+# file $1, so that the configured state is checked again after the setter.
+# the profile hook of --instrument stays the first statement.
+function mark_unchecked_in_setters(){
+    awk '
+      pending {
+          pending = 0
+          if ($0 ~ /^[ \t]*METHOD_PROFILE_ENTER\(/) {
+              print
+              print "    " statement
+              next
+          }
+          print "    " statement
+      }
+
+      { print }
+
+      in_setter && /^\{/ {
+          in_setter = 0
+          pending = 1
+          next
+      }
+
+      $0 ~ "^[a-zA-Z_][a-zA-Z_* ]+ (" self "_)?set[a-zA-Z_]*\\(" {
+          in_setter = 1
+      }
+    ' self=${self} statement="$2" $1 > mgfile
+    mv mgfile $1
+}
+
+
+# find the methods in file $1 which can be declared with attributes, their
+# declarations with the attributes are appended to atfile. a trivial getter,
+# whose body is only a return without calls or assignments, is pure; it is
+# const if the return uses only its parameters. a body with an assertion is
+# not, the compiler could drop the call and the assertion with it. the receiver
+# of a pure member method is restrict as well, for nothing is written through
+# it. methods listed in ${hot_file} are hot.
+function annotate_methods(){
+    awk '
+      FILENAME == hot_file {
+        if ($1 == self) hot[self "_" $2] = 1
+        next
+      }
+
+      {
+        line[++line_num] = $0
+      }
+
+      function trim(text) {
+        sub(/\r$/, "", text)
+        gsub(/^[\t ]+|[\t ]+$/, "", text)
+        return text
+      }
+
+      function attributes_of(first, last, params,    k, t, expr, names, n, i, words, w,
+                             known) {
+        ret_num = 0
+        other_num = 0
+        expr = ""
+        for (k = first; k <= last; k++) {
+          t = trim(line[k])
+          if (t == "" || t ~ /^\/\//) continue
+          if (t ~ /^return[ (]/ && t ~ /; *$/) {
+            ret_num++
+            expr = t
+            sub(/^return */, "", expr)
+            sub(/ *; *$/, "", expr)
+            continue
+          }
+          other_num++
+        }
+
+        if (other_num != 0 || ret_num != 1) return ""
+        if (expr ~ /[a-zA-Z_0-9] *\(/ || expr ~ /\+\+|--/) return ""
+        t = expr
+        gsub(/==|!=|<=|>=/, "", t)
+        if (t ~ /=/) return ""
+
+        # const: only the parameters and constants are read.
+        if (params !~ /This/ && expr !~ /->|\.|\[|\*/) {
+          n = split(params, names, ",")
+          for (i = 1; i <= n; i++) {
+            sub(/\[.*/, "", names[i])
+            sub(/.*[^a-zA-Z_0-9]/, "", names[i])
+            known[names[i]] = 1
+          }
+          known["true"] = known["false"] = known["pNULL"] = known["NULL"] = 1
+
+          n = split(expr, words, /[^a-zA-Z_0-9]+/)
+          for (i = 1; i <= n; i++) {
+            w = words[i]
+            if (w != "" && w !~ /^[0-9]/ && !(w in known)) return "ATTRIBUTE_PURE"
+          }
+          return "ATTRIBUTE_CONST"
+        }
+
+        return "ATTRIBUTE_PURE"
+      }
+
+      END {
+        for (i = 1; i <= line_num; i++) {
+          decl = trim(line[i])
+          if (decl !~ /^[a-zA-Z_].*\)$/ || i == line_num || trim(line[i + 1]) != "{") continue
+
+          for (j = i + 2; j <= line_num && trim(line[j]) != "}"; j++);
+
+          name = decl
+          sub(/\(.*/, "", name)
+          sub(/.*[^a-zA-Z_0-9]/, "", name)
+          params = decl
+          sub(/^[^(]*\(/, "", params)
+          sub(/\)$/, "", params)
+
+          attrs = attributes_of(i + 2, j - 1, params)
+          if (attrs != "" && params ~ "^const " self " \\*This") {
+            sub("const " self " \\*This", "const " self " *RESTRICT This", line[i])
+            sub("const " self " \\*This", "const " self " *RESTRICT This", decl)
+          }
+          if (name in hot) attrs = (attrs == "") ? "ATTRIBUTE_HOT" : attrs " ATTRIBUTE_HOT"
+
+          if (attrs != "") print decl " " attrs ";" >> attribute_file
+          i = j
+        }
+
+        for (i = 1; i <= line_num; i++) print line[i]
+      }
+    ' self=${self} hot_file=${hot_file:-/dev/null} attribute_file=atfile \
+      ${hot_file:-/dev/null} $1 > mgfile
+    mv mgfile $1
 }
 
 
@@ -1125,6 +3521,43 @@ if [ -s cffile ];
 then
     process_non_virtual_method "cf"
 
+    if [[ ${tracks_configured} == "yes" ]];
+    then
+        mark_unchecked_in_setters cffile "${configured_root}_markAllUnchecked();"
+    fi
+
+    # the state of the objects is allocated with the system list, when its
+    # size is known.
+    if [[ ${tracks_configured} == "yes" && ${self} == ${configured_root} ]];
+    then
+        sed -i -e "/^void ${self}_setSystemListSize(/,/^}/{" \
+               -e "/_markAllUnchecked();/d" \
+               -e "/^}/i\\    ${self}_allocateObjectState();" \
+               -e "}" cffile
+    fi
+
+    # the original trace services send to the tracer directly, the buffered
+    # ones are generated below.
+    if [[ ${buffers_trace} == "yes" ]];
+    then
+        sed -i \
+            -e "s/^void ${self}_synchTrace(/void ${self}_synchTraceUnbuffered(/" \
+            -e "s/^void ${self}_packetTrace(/void ${self}_packetTraceUnbuffered(/" \
+            cffile
+    fi
+
+    # the root class keeps the original scan, isSystemConfigured is generated
+    # with the configured state tracking below.
+    if [[ ${tracks_configured} == "yes" && ${self} == ${configured_root} ]];
+    then
+        sed -i "s/^\(.*\) ${self}_isSystemConfigured(void)/\1 ${self}_isSystemConfiguredScan(void)/" cffile
+    fi
+
+    if [[ ${attributes} == "yes" ]];
+    then
+        annotate_methods cffile
+    fi
+
     echo -e "\n"
     echo "///////////////////////////////////////////////////////////////////////////////"
     echo "//"
@@ -1141,6 +3574,16 @@ then
 
     process_non_virtual_method "om"
 
+    if [[ ${tracks_configured} == "yes" ]];
+    then
+        mark_unchecked_in_setters omfile "${configured_root}_markUnchecked(This);"
+    fi
+
+    if [[ ${attributes} == "yes" ]];
+    then
+        annotate_methods omfile
+    fi
+
     echo -e "\n"
     echo "///////////////////////////////////////////////////////////////////////////////"
     echo "//"
@@ -1154,11 +3597,188 @@ fi
 
 
 
+###
+###  configured state tracking
+###
+
+# objects are marked unchecked when they are created or a setter is called,
+# and only the marked ones are checked by isSystemConfigured, which keeps the
+# number of objects not configured; the full scan is still available and is
+# used for cross-checking if CHECK_CONFIGURED_TRACKING is defined.
+if [[ ${tracks_configured} == "yes" && ${self} == ${configured_root} ]];
+then
+    echo -e "\n"
+    echo "///////////////////////////////////////////////////////////////////////////////"
+    echo "//"
+    echo "//                      configured state tracking"
+    echo "//"
+    echo "///////////////////////////////////////////////////////////////////////////////"
+    echo ""
+    echo "#include <stdlib.h>"
+    echo ""
+    echo "#define OBJECT_STATE_UNKNOWN     0"
+    echo "#define OBJECT_CONFIGURED        1"
+    echo "#define OBJECT_NOT_CONFIGURED    2"
+    echo "#define OBJECT_UNCHECKED         3"
+    echo ""
+    echo "// the configured state of each object in the system list, indexed by"
+    echo "// instance identifier, and the objects to be checked again."
+    echo "static unsigned char *pObjectState = pNULL;"
+    echo "static TD_InstanceId *pUncheckedList = pNULL;"
+    echo "static TD_InstanceId uncheckedNumber = 0;"
+    echo "static TD_InstanceId notConfiguredNumber = 0;"
+    echo ""
+    echo "void ${self}_allocateObjectState(void)"
+    echo "{"
+    echo "    pObjectState = calloc(systemListSize, sizeof(unsigned char));"
+    echo "    pUncheckedList = malloc(systemListSize * sizeof(TD_InstanceId));"
+    echo ""
+    echo "    if ( pObjectState == pNULL || pUncheckedList == pNULL ) {"
+    echo "        free(pObjectState);"
+    echo "        free(pUncheckedList);"
+    echo "        pObjectState = pNULL;"
+    echo "        pUncheckedList = pNULL;"
+    echo "    }"
+    echo "}"
+    echo ""
+    echo "void ${self}_markUnchecked(void *obj)"
+    echo "{"
+    echo "    TD_InstanceId id = ${uppercase_self}(obj)->instanceId;"
+    echo ""
+    echo "    // objects not loaded in the system list are not checked at all."
+    echo "    if ( pObjectState == pNULL || id >= systemListSize )"
+    echo "        return;"
+    echo ""
+    echo "    if ( pObjectState[id] == OBJECT_UNCHECKED )"
+    echo "        return;"
+    echo "    if ( pObjectState[id] == OBJECT_NOT_CONFIGURED )"
+    echo "        notConfiguredNumber--;"
+    echo ""
+    echo "    pObjectState[id] = OBJECT_UNCHECKED;"
+    echo "    pUncheckedList[uncheckedNumber++] = id;"
+    echo "}"
+    echo ""
+    echo "void ${self}_markAllUnchecked(void)"
+    echo "{"
+    echo "    for (TD_InstanceId i=0; i<instanceCounter; i++)"
+    echo "        ${self}_markUnchecked(pSystemList[i]);"
+    echo "}"
+    echo ""
+    echo "bool ${self}_isSystemConfigured(void)"
+    echo "{"
+    echo "    bool configured;"
+    echo ""
+    echo "    if ( pObjectState == pNULL )"
+    echo "        return ${self}_isSystemConfiguredScan();"
+    echo ""
+    echo "    while ( uncheckedNumber > 0 ) {"
+    echo "        TD_InstanceId id = pUncheckedList[--uncheckedNumber];"
+    echo "        ${self} *obj = pSystemList[id];"
+    echo ""
+    echo "        if ( ${uppercase_self}_GET_CLASS(obj)->isObjectConfigured(obj) ) {"
+    echo "            pObjectState[id] = OBJECT_CONFIGURED;"
+    echo "        } else {"
+    echo "            pObjectState[id] = OBJECT_NOT_CONFIGURED;"
+    echo "            notConfiguredNumber++;"
+    echo "        }"
+    echo "    }"
+    echo ""
+    echo "    configured = (notConfiguredNumber == 0) ? CONFIGURED : NOT_CONFIGURED;"
+    echo "#ifdef CHECK_CONFIGURED_TRACKING"
+    echo "    assert( configured == ${self}_isSystemConfiguredScan() );"
+    echo "#endif"
+    echo "    return configured;"
+    echo "}"
+fi
+
+
+
+
+###
+###  trace buffer
+###
+
+# synchTrace stores the trace item in a ring buffer written by a single
+# producer, the buffer is sent to the tracer as packet traces when it is full
+# or flushed, and before a packet trace to keep the order of trace items.
+if [[ ${buffers_trace} == "yes" ]];
+then
+    buffer_size=${uppercase_self}_TRACE_BUFFER_SIZE
+
+    echo -e "\n"
+    echo "///////////////////////////////////////////////////////////////////////////////"
+    echo "//"
+    echo "//                             trace buffer"
+    echo "//"
+    echo "///////////////////////////////////////////////////////////////////////////////"
+    echo ""
+    echo "#ifndef ${buffer_size}"
+    echo "#define ${buffer_size} ${trace_buffer_size}"
+    echo "#endif"
+    echo ""
+    echo "#if (${buffer_size} & (${buffer_size} - 1)) != 0"
+    echo "#error \"${buffer_size} should be a power of 2\""
+    echo "#endif"
+    echo ""
+    echo "// items are written at traceHead and sent from traceTail, both of them"
+    echo "// only increase and are wrapped when the buffer is accessed."
+    echo "static TD_TraceItem traceBuffer[${buffer_size}];"
+    echo "static unsigned int traceHead = 0;"
+    echo "static unsigned int traceTail = 0;"
+    echo "static unsigned int traceHighWater = 0;"
+    echo ""
+    echo "void ${self}_flushTrace(void)"
+    echo "{"
+    echo "    // the number of buffered items is the largest just before a flush."
+    echo "    if ( traceHead - traceTail > traceHighWater )"
+    echo "        traceHighWater = traceHead - traceTail;"
+    echo ""
+    echo "    while ( traceTail != traceHead ) {"
+    echo "        unsigned int start = traceTail & (${buffer_size} - 1);"
+    echo "        unsigned int n = traceHead - traceTail;"
+    echo ""
+    echo "        // the items wrapped to the begining are sent in the next packet."
+    echo "        if ( start + n > ${buffer_size} )"
+    echo "            n = ${buffer_size} - start;"
+    echo ""
+    echo "        ${self}_packetTraceUnbuffered(n, &traceBuffer[start]);"
+    echo "        traceTail += n;"
+    echo "    }"
+    echo "}"
+    echo ""
+    echo "unsigned int ${self}_getTraceHighWater(void)"
+    echo "{"
+    echo "    if ( traceHead - traceTail > traceHighWater )"
+    echo "        return traceHead - traceTail;"
+    echo "    return traceHighWater;"
+    echo "}"
+    echo ""
+    echo "void ${self}_synchTrace(TD_TraceItem traceId)"
+    echo "{"
+    echo "    traceBuffer[traceHead & (${buffer_size} - 1)] = traceId;"
+    echo "    traceHead++;"
+    echo ""
+    echo "    if ( traceHead - traceTail == ${buffer_size} )"
+    echo "        ${self}_flushTrace();"
+    echo "}"
+    echo ""
+    echo "void ${self}_packetTrace(unsigned int n, TD_TraceItem traceData[])"
+    echo "{"
+    echo "    ${self}_flushTrace();"
+    echo "    ${self}_packetTraceUnbuffered(n, traceData);"
+    echo "}"
+fi
+
+
+
+
 
 ###
 ### process virtual methods
 ###
 
+profile_phase "virtual_methods"
+
 # add staic keyword at the begining of the function decalaration for virtual
 # methods.
 sed -i\
@@ -1212,6 +3832,11 @@ function process_virtual_method(){
         # Warning: for some pure virtual functions, there are no function body
         # in sources file, we must produce a default body for them.
         append_function_body_to $1list $1dfile
+
+        if [[ $1 == "vf" && ${tracks_configured} == "yes" ]];
+        then
+            mark_unchecked_in_setters $1dfile "${configured_root}_markUnchecked(obj);"
+        fi
     
         case "$1" in
             "vf")
@@ -1261,10 +3886,67 @@ fi
 
 
 
+###
+###  direct call of devirtualized virtual methods
+###
+
+# virtual methods with a single implementation in the whole class hierarchy
+# can be called directly, without looking up the class of the object; the
+# direct call is a plain function wrapping the static virtual method.
+touch dcdfile
+if [[ ${direct_calls_file} != '' ]] && [ -e vflist ];
+then
+    sed -n "s/^${self} \([a-zA-Z_][a-zA-Z_0-9]*\) .*/\1/p" \
+        ${direct_calls_file} > dclist
+
+    while read func_name;
+    do
+        # only the implementation in this class can be called directly.
+        if ! grep -q "^${func_name}$" vflist;
+        then
+            continue
+        fi
+
+        func_header=$(sed -n "/ ${func_name}(/p" vffile)
+        func_decl=$(sed "s/^static \(.*\) ${func_name}(/\1 ${self}_${func_name}_direct(/" \
+            <<< "${func_header}")
+        func_para=${func_header#*(}
+        func_para=${func_para%)*}
+
+        if [ ! -s dcdfile ];
+        then
+            echo -e "\n"
+            echo "///////////////////////////////////////////////////////////////////////////////"
+            echo "//"
+            echo "//                 direct call(s) of virtual method(s)"
+            echo "//"
+            echo "///////////////////////////////////////////////////////////////////////////////"
+        fi
+
+        echo "${func_decl};" >> dcdfile
+
+        echo ""
+        echo "${func_decl}"
+        echo "{"
+        if [[ ${func_decl} == "void "* ]];
+        then
+            echo "    ${func_name}($(formal_parameter_names "${func_para}"));"
+        else
+            echo "    return ${func_name}($(formal_parameter_names "${func_para}"));"
+        fi
+        echo "}"
+    done < dclist
+fi
+
+
+
+
 ###
 ###  process constructor and destructor 
 ###
 
+profile_phase "constructor_destructor"
+
 echo -e "\n"
 echo "///////////////////////////////////////////////////////////////////////////////"
 echo "//"
@@ -1291,49 +3973,109 @@ else
 
     echo "static void post_init(${self} *This, ${para_list})"
 fi
-extract_function_body "$(construct_pattern ${self} ${self})"
-cat fbfile
+extract_function_body "$(construct_key ${self} ${self})"
 
+# a new object is checked by the next isSystemConfigured. it is marked when
+# the constructor is left, after its instance identifier is set, so an early
+# return marks it as well.
+if [[ ${tracks_configured} == "yes" && ${self} == ${configured_root} ]] && \
+   [ -s fbfile ];
+then
+    if [[ ${para_list} == '' ]];
+    then
+        mark_statement="${self}_markUnchecked(obj);"
+    else
+        mark_statement="${self}_markUnchecked(This);"
+    fi
+    sed -i \
+        -e "s/\(^\|[^a-zA-Z_0-9]\)return *;/\1{ ${mark_statement} return; }/g" \
+        -e "\$i\\    ${mark_statement}" fbfile
+fi
+cat fbfile
 
-# class-specific new function
-echo ""
-echo "${self}* ${self}_new(${para_list:-void})"
-echo "{"
 
-if [[ ${para_list} == '' ]];
+# class-specific new function, abstract classes have no instances and so
+# have no object pool.
+if [[ ${object_pool_size} != '' ]] && [ ! -s pvffile ];
 then
-    echo "    return (${self}*)object_new(TYPE_${uppercase_self});"
+    echo ""
+    echo "#ifndef ${uppercase_self}_POOL_SIZE"
+    echo "#define ${uppercase_self}_POOL_SIZE ${object_pool_size}"
+    echo "#endif"
+    echo ""
+    echo "// instances are allocated from a static pool of the class, so they are"
+    echo "// contiguous and no heap is used during the initialization; the heap is"
+    echo "// used only if the pool is too small."
+    echo "static ${self} pool[${uppercase_self}_POOL_SIZE];"
+    echo "static unsigned int pool_used = 0;"
+    echo ""
+    echo "${self}* ${self}_new(${para_list:-void})"
+    echo "{"
+    echo "    ${self} *obj;"
+    echo ""
+    echo "    assert( pool_used < ${uppercase_self}_POOL_SIZE );"
+    echo "    if ( pool_used < ${uppercase_self}_POOL_SIZE ) {"
+    echo "        obj = &pool[pool_used++];"
+
+    if [[ ${para_list} == '' ]];
+    then
+        echo "        ${self}_init(obj);"
+        echo "    } else {"
+        echo "        obj = (${self}*)object_new(TYPE_${uppercase_self});"
+    else
+        list=$(formal_parameter_names "${para_list}")
+        echo "        ${self}_init(obj, ${list});"
+        echo "    } else {"
+        echo "        obj = (${self}*)object_new(TYPE_${uppercase_self});"
+        echo "        post_init(obj, ${list});"
+    fi
+
+    echo "    }"
+    echo ""
+    echo "    return obj;"
+    echo "}"
 else
-     echo "${para_list}" | tr ',' '\n' > formal_para
-     sed -i\
-         -e 's/\([a-zA-Z_\*]\+\) \+\([a-zA-Z_]\)/\2/g'\
-         -e 's/\([a-zA-Z_]\+\) \+\**\([a-zA-Z_]\+\)/\2/g'\
-         -e 's/^[ ]\+//g' formal_para 
-
-     list=''
-     while read line;
-     do
-        if [[ $list == '' ]];
-        then 
-            list="$line"; 
-        else 
-            list="$list, $line"; 
-        fi;
-     done < formal_para
+    echo ""
+    echo "${self}* ${self}_new(${para_list:-void})"
+    echo "{"
+
+    if [[ ${para_list} == '' ]];
+    then
+        echo "    return (${self}*)object_new(TYPE_${uppercase_self});"
+    else
+         list=$(formal_parameter_names "${para_list}")
+
+         echo "   Object *obj = object_new(TYPE_${uppercase_self});"
+         echo "   post_init((${self}*)obj, ${list});"
+         echo ""
+         echo "   return (${self}*)obj;"
+    fi
+
+    echo "}"
+fi
+
+
+# class-specific init function, which initializes the object in place, runs
+# instance_init of the class and its ancestors like object_new, and then the
+# constructor with parameters.
+if [ ! -s pvffile ];
+then
+    echo ""
+    echo "void ${self}_init(${self} *storage${para_list:+, ${para_list}})"
+    echo "{"
+    echo "    object_initialize(storage, sizeof(${self}), TYPE_${uppercase_self});"
 
-     rm -f formal_para
+    if [[ ${para_list} != '' ]];
+    then
+        echo "    post_init(storage, $(formal_parameter_names "${para_list}"));"
+    fi
 
-     echo "   Object *obj = object_new(TYPE_${uppercase_self});"
-     echo "   post_init((${self}*)obj, ${list});"
-     echo ""
-     echo "   return (${self}*)obj;"
+    echo "}"
 fi
 
-echo "}"
-
 
 # destructor, this is optional
-extract_function_body "$(construct_pattern ${self} ~${self})"
+extract_function_body "$(construct_key ${self} ~${self})"
 if [ -s fbfile ];
 then
    echo ""
@@ -1355,6 +4097,21 @@ echo -e "\n"
 ###   process binding and type registration 
 ###
 
+profile_phase "bindings"
+
+# the local variable for the class struct of class $1 in class_init, it is
+# declared before its first binding; the names are made of the whole class
+# names, so they never clash.
+declare -A class_struct_variable
+function declare_class_struct_variable(){
+    if [[ ${class_struct_variable[$1]} == '' ]];
+    then
+        class_struct_variable[$1]=$(echo "$1" | tr 'A-Z' 'a-z')_class
+        echo "    $1Class *${class_struct_variable[$1]} =" \
+             "$(echo $1 | tr 'a-z' 'A-Z')_CLASS(oc);"
+    fi
+}
+
 function add_bindings(){
     if [ $# -lt 2 ];
     then
@@ -1362,10 +4119,43 @@ function add_bindings(){
         exit 1
     fi
 
-    # add a list of bindings
+    # add a list of bindings to the class struct of class $2
+    while read func_name_line;
+    do
+       declare_class_struct_variable $2
+       echo "    ${class_struct_variable[$2]}->${func_name_line} = ${func_name_line};"
+    done < $1
+}
+
+
+# add bindings to the class struct of the owner of each virtual method. if $3
+# is given, methods whose owner can not be decided are written to it, otherwise
+# they are bound to self class.
+function add_resolved_bindings(){
+    if [ $# -lt 2 ];
+    then
+        echo "need a file includes function name list and class name."
+        exit 1
+    fi
+
+    if [[ $3 != '' ]];
+    then
+        rm -f $3
+        touch $3
+    fi
+
     while read func_name_line;
     do
-       echo "    $2->${func_name_line} = ${func_name_line};"
+        owner=$(virtual_owner_of ${func_name_line})
+
+        if [[ ${owner} == '' && $3 != '' ]];
+        then
+            echo "${func_name_line}" >> $3
+            continue
+        fi
+
+        declare_class_struct_variable ${owner:-$2}
+        echo "    ${class_struct_variable[${owner:-$2}]}->${func_name_line} = ${func_name_line};"
     done < $1
 }
 
@@ -1377,42 +4167,46 @@ echo "//"
 echo "///////////////////////////////////////////////////////////////////////////////"
 echo ""
 
-self_class_name=$(echo "${self_class}" | tr -d 'a-z' | tr 'A-Z' 'a-z')
-parent_class_name=$(echo "${parent_class}" | tr -d 'a-z' | tr 'A-Z' 'a-z')
-
 # class init
 echo "static void class_init(ObjectClass *oc, void *data)"
 echo "{"
 
-if [ -e pvflist ] || [ -e vflist ];
+# the class struct is copied from the parent class, the identifier is set
+# before the class struct is casted.
+if [[ ${uses_class_ids} == "yes" ]];
 then
-    echo "    ${self_class} *${self_class_name} = ${uppercase_self}_CLASS(oc);"
+    echo "    TYPE_ID_OF_CLASS(oc) = TYPE_ID_${uppercase_self};"
+    if [ -e pvflist ] || [ -e vflist ];
+    then
+        echo ""
+    fi
 fi
 
-
 if [ -e pvflist ];
 then
-    echo ""
-    add_bindings pvflist ${self_class_name}
+    add_resolved_bindings pvflist ${self}
 fi
 
 
 # for non-pure virtual function, we often have no idea about whether it is
 # in parent class or in self class; but if we know the parent is Objectclass,
-# we can sure that the virtual function should defined in self class.
+# we can sure that the virtual function should defined in self class. the
+# class hierarchy index tells us the class of the others.
 if [ -e vflist ];
 then
-    echo ""
-
     if [[ ${parent} == "Object" ]];
     then
-        add_bindings vflist ${self_class_name}
+        add_bindings vflist ${self}
     else
+        add_resolved_bindings vflist ${self} unknown_vflist
+    fi
+
+    if [ -s unknown_vflist ];
+    then
         echo ">>> // some bindings may not right, please check yourself."
-        echo "    ${parent_class} *${parent_class_name} = ${uppercase_parent}_CLASS(oc);"
-        add_bindings vflist ${parent_class_name}
+        add_bindings unknown_vflist ${parent}
         echo "<<<" 
-        add_bindings vflist ${self_class_name}
+        add_bindings unknown_vflist ${self}
         echo ">>>"
     fi
 
@@ -1420,9 +4214,17 @@ fi
 
 echo "}"
 
-# type information
-echo ""
-echo "static const TypeInfo type_info = {"
+# type information, which is exported for the registration unit of a project.
+if [[ ${export_type_info} == "yes" ]];
+then
+    type_info=${self}_type_info
+    echo ""
+    echo "const TypeInfo ${type_info} = {"
+else
+    type_info=type_info
+    echo ""
+    echo "static const TypeInfo type_info = {"
+fi
 echo "    .name = TYPE_${uppercase_self},"
 echo "    .parent = TYPE_${uppercase_parent},"
 echo "    .instance_size = sizeof(${self}),"
@@ -1453,7 +4255,7 @@ echo "};"
 echo ""
 echo "void ${self}_register(void)"
 echo "{"
-echo "    type_register_static(&type_info);"
+echo "    type_register_static(&${type_info});"
 echo "}"
 
 
@@ -1463,9 +4265,691 @@ echo "}"
 ###
 ### postprocess for .c file
 ###
+
+profile_phase "finish"
 dos2unix ${c_source_file}>&/dev/null
 
+# the line of the last include preceding the first section or conditional of
+# file $1.
+function last_leading_include(){
+    awk '
+      /^\/\/\/\/\/\/\/\/|^#if/ { exit }
+      /^#include/ { last = NR }
+      END { print last }
+    ' $1
+}
+
+# the profile table is known only after all methods are instrumented, so it
+# is inserted after the includes, and the dump function appended at the end.
+if [ -s pnfile ];
+then
+    {
+        echo ""
+        echo "#ifdef METHOD_PROFILE"
+        echo "#include <stdio.h>"
+        echo "#include <time.h>"
+        echo ""
+        echo "typedef struct MethodProfile {"
+        echo "    unsigned long calls;"
+        echo "    unsigned long long cycles;"
+        echo "} MethodProfile;"
+        echo ""
+        echo "typedef struct MethodProfileScope {"
+        echo "    MethodProfile *profile;"
+        echo "    unsigned long long start;"
+        echo "} MethodProfileScope;"
+        echo ""
+        echo "static MethodProfile method_profile[$(wc -l < pnfile)];"
+        echo ""
+        echo "static const char *const method_profile_names[] = {"
+        sed 's/.*/    "&",/' pnfile
+        echo "};"
+        echo ""
+        echo "// cycles of the time stamp counter, nanoseconds on other targets."
+        echo "static inline unsigned long long method_profile_now(void)"
+        echo "{"
+        echo "#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))"
+        echo "    return __builtin_ia32_rdtsc();"
+        echo "#else"
+        echo "    struct timespec now;"
+        echo ""
+        echo "    clock_gettime(CLOCK_MONOTONIC, &now);"
+        echo "    return (unsigned long long)now.tv_sec*1000000000ULL + now.tv_nsec;"
+        echo "#endif"
+        echo "}"
+        echo ""
+        echo "static inline void method_profile_exit(MethodProfileScope *scope)"
+        echo "{"
+        echo "    scope->profile->calls++;"
+        echo "    scope->profile->cycles += method_profile_now() - scope->start;"
+        echo "}"
+        echo ""
+        echo "// the exit hook runs when the scope of the method is left, by any return."
+        echo "#define METHOD_PROFILE_ENTER(n) \\"
+        echo "    MethodProfileScope method_profile_scope \\"
+        echo "        __attribute__((cleanup(method_profile_exit))) = \\"
+        echo "        { &method_profile[n], method_profile_now() }"
+        echo "#else"
+        echo "#define METHOD_PROFILE_ENTER(n)"
+        echo "#endif"
+    } > ptfile
+    sed -i "$(last_leading_include ${c_source_file})r ptfile" ${c_source_file}
+
+    {
+        echo -e "\n"
+        echo "///////////////////////////////////////////////////////////////////////////////"
+        echo "//"
+        echo "//                          method profile"
+        echo "//"
+        echo "///////////////////////////////////////////////////////////////////////////////"
+        echo ""
+        echo "void ${self}_dump_profile(void)"
+        echo "{"
+        echo "#ifdef METHOD_PROFILE"
+        echo "    for (unsigned int i=0; i<sizeof(method_profile)/sizeof(method_profile[0]); i++)"
+        echo "        if (method_profile[i].calls != 0)"
+        echo "            printf(\"%-48s %10lu calls %14llu cycles %10llu cycles/call\\n\","
+        echo "                   method_profile_names[i], method_profile[i].calls,"
+        echo "                   method_profile[i].cycles,"
+        echo "                   method_profile[i].cycles/method_profile[i].calls);"
+        echo "#endif"
+        echo "}"
+    } >> ${c_source_file}
+fi
+
+# the class data are members of class_data after the layout pass, so their
+# references following its definition are qualified. file $1 is rewritten
+# from line $2, $3 is the list of the class data names. only the identifiers
+# in code are references: comments and literals are kept, and so are the
+# function headers and the names shadowed by a parameter or a local variable
+# of the function.
+function qualify_class_data(){
+    awk -v names="$3" '
+      BEGIN {
+        name_num = split(names, name_list, " ")
+        for (i = 1; i <= name_num; i++) class_data[name_list[i]] = 1
+      }
+
+      # a parameter or a local variable of the current function.
+      function shadow(declarators,    parts, part_num, p, name) {
+        part_num = split(declarators, parts, ",")
+        for (p = 1; p <= part_num; p++) {
+          name = parts[p]
+          sub(/=.*/, "", name)
+          sub(/\[.*/, "", name)
+          if (match(name, /[a-zA-Z_][a-zA-Z_0-9]*[ \t]*$/)) {
+            name = substr(name, RSTART)
+            sub(/[ \t]+$/, "", name)
+            shadowed[name] = 1
+          }
+        }
+      }
+
+      function qualify(line,    out, c, two, close_at, token, before) {
+        out = ""
+        while (line != "") {
+          if (in_comment) {
+            close_at = index(line, "*/")
+            if (close_at == 0) return out line
+            out = out substr(line, 1, close_at + 1)
+            line = substr(line, close_at + 2)
+            in_comment = 0
+            continue
+          }
+
+          c = substr(line, 1, 1)
+          two = substr(line, 1, 2)
+          if (two == "//") return out line
+          if (two == "/*") {
+            in_comment = 1
+            out = out two
+            line = substr(line, 3)
+          } else if (c == "\"" || c == "\047") {
+            for (close_at = 2; close_at <= length(line); close_at++) {
+              if (substr(line, close_at, 1) == "\\") close_at++
+              else if (substr(line, close_at, 1) == c) break
+            }
+            out = out substr(line, 1, close_at)
+            line = substr(line, close_at + 1)
+          } else if (match(line, /^[a-zA-Z_][a-zA-Z_0-9]*/) || \
+                     match(line, /^[0-9][a-zA-Z_0-9.]*/)) {
+            token = substr(line, 1, RLENGTH)
+            line = substr(line, RLENGTH + 1)
+            before = out
+            sub(/[ \t]+$/, "", before)
+            if ((token in class_data) && !(token in shadowed) && \
+                before !~ /(\.|->|::)$/)
+              token = "class_data." token
+            out = out token
+          } else {
+            out = out c
+            line = substr(line, 2)
+          }
+        }
+        return out
+      }
+
+      NR < first { print; next }
+
+      # a function header, its parameters shadow the class data in the body.
+      !in_comment && /^[a-zA-Z_][^;=]*\(.*\)[ \t]*$/ && !/^#/ {
+        split("", shadowed)
+        header = $0
+        sub(/^[^(]*\(/, "", header)
+        sub(/\)[^)]*$/, "", header)
+        shadow(header)
+        print
+        next
+      }
+
+      # a local variable declaration in a function body.
+      !in_comment && /^[ \t]/ && \
+        match($0, /^[ \t]*([a-zA-Z_][a-zA-Z_0-9]*[ \t*]+)+[a-zA-Z_][a-zA-Z_0-9]*[ \t]*(\[[a-zA-Z_0-9 +*]*\])?[ \t]*(=|;|,)/) && \
+        !/^[ \t]*(return|else|case|goto|delete|throw|sizeof)[ \t*(]/ {
+        shadow(substr($0, 1, RLENGTH - 1))
+        print qualify($0)
+        next
+      }
+
+      /^}/ { split("", shadowed) }
+
+      { print qualify($0) }
+    ' first=$2 $1 > qcfile
+    mv qcfile $1
+}
+
+if [[ ${class_data_names} != '' ]];
+then
+    class_data_line=$(grep -n "^} class_data " ${c_source_file} | cut -d: -f1)
+    qualify_class_data ${c_source_file} $((class_data_line+1)) "${class_data_names}"
+fi
+
+
+
+
+
+###
+### emit static inline methods and finish ${self}.h file
+###
+
+exec 1>>${c_header}
+
+if [ -s dcdfile ];
+then
+   echo -e "\n"
+   echo "///////////////////////////////////////////////////////////////////////////////"
+   echo "//"
+   echo "//              direct call(s) of virtual method(s) declaration"
+   echo "//"
+   echo "///////////////////////////////////////////////////////////////////////////////"
+   echo ""
+   echo "// the following virtual method(s) have a single implementation in the whole"
+   echo "// class hierarchy, so they can be called without looking up the class."
+   cat dcdfile
+fi
+
+if [ -s pnfile ];
+then
+   echo -e "\n"
+   echo "///////////////////////////////////////////////////////////////////////////////"
+   echo "//"
+   echo "//                      method profile declaration"
+   echo "//"
+   echo "///////////////////////////////////////////////////////////////////////////////"
+   echo ""
+   echo "// print the calls and cycles of each method of the class, which are counted"
+   echo "// only if the class is compiled with METHOD_PROFILE."
+   echo "void ${self}_dump_profile(void);"
+fi
+
+# the attributes are added by redeclaring the methods, the receivers of the
+# first declarations are not restrict, which does not change their type.
+if [ -s atfile ];
+then
+   echo -e "\n"
+   echo "///////////////////////////////////////////////////////////////////////////////"
+   echo "//"
+   echo "//                        method attribute(s)"
+   echo "//"
+   echo "///////////////////////////////////////////////////////////////////////////////"
+   echo ""
+   echo "#ifndef ATTRIBUTE_PURE"
+   echo "#if defined(__GNUC__)"
+   echo "#define ATTRIBUTE_PURE __attribute__((pure))"
+   echo "#define ATTRIBUTE_CONST __attribute__((const))"
+   echo "#define ATTRIBUTE_HOT __attribute__((hot))"
+   echo "#else"
+   echo "#define ATTRIBUTE_PURE"
+   echo "#define ATTRIBUTE_CONST"
+   echo "#define ATTRIBUTE_HOT"
+   echo "#endif"
+   echo "#endif"
+   echo ""
+   echo "#ifndef RESTRICT"
+   echo "#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L"
+   echo "#define RESTRICT restrict"
+   echo "#elif defined(__GNUC__)"
+   echo "#define RESTRICT __restrict__"
+   echo "#else"
+   echo "#define RESTRICT"
+   echo "#endif"
+   echo "#endif"
+   echo ""
+   cat atfile
+fi
+
+if [ -s ilfile ];
+then
+   echo -e "\n"
+   echo "///////////////////////////////////////////////////////////////////////////////"
+   echo "//"
+   echo "//                   static inline method(s) definition"
+   echo "//"
+   echo "///////////////////////////////////////////////////////////////////////////////"
+   echo ""
+   if [ -s ilifile ];
+   then
+       cat ilifile
+       echo ""
+   fi
+   cat ilfile
+fi
+
+echo  ""
+echo "#endif"
+dos2unix  ${c_header} >&/dev/null
+
 exec 1>&${saved_stdout}
+
+
+
+
+
+###
+### prune the includes of ${self}.h
+###
+
+# an included header named after a class, whose type is used only by pointer
+# in ${self}.h, is replaced with a forward typedef of the struct; one which
+# is not used at all is removed if it is known to declare a class (i.e. from
+# the class hierarchy index), for it may declare other types. the removed
+# includes are moved to the .c, where the complete types may be needed.
+function prune_header_includes(){
+    local header=$1
+    local source=$2
+
+    awk '
+      FILENAME == hierarchy {
+        if ($1 == "class") known[$2] = 1
+        next
+      }
+
+      {
+        line[++line_num] = $0
+        text = $0
+
+        # the comments do not use the types.
+        if (in_comment) {
+          if (!sub(/.*\*\//, "", text)) next
+          in_comment = 0
+        }
+        gsub(/\/\*([^*]|\*+[^*\/])*\*+\//, "", text)
+        if (sub(/\/\*.*/, "", text)) in_comment = 1
+        sub(/\/\/.*/, "", text)
+
+        if (text ~ /^#include *"/) {
+          type = text
+          sub(/^#include *"/, "", type)
+          sub(/".*/, "", type)
+          sub(/.*\//, "", type)
+          if (sub(/\.h$/, "", type) && type != self) include_of[line_num] = type
+          next
+        }
+
+        while (match(text, /[a-zA-Z_][a-zA-Z_0-9]*/)) {
+          word = substr(text, RSTART, RLENGTH)
+          text = substr(text, RSTART + RLENGTH)
+          if (text ~ /^[\t ]*\*/) by_pointer[word]++
+          else by_value[word]++
+        }
+      }
+
+      END {
+        for (i = 1; i <= line_num; i++) {
+          if (!(i in include_of)) {
+            print line[i]
+            continue
+          }
+
+          type = include_of[i]
+          if (type in by_value || !(type in by_pointer || type in known)) {
+            print line[i]
+            continue
+          }
+
+          print line[i] > moved
+          if (type in by_pointer) {
+            upper = toupper(type)
+            print "#ifndef " upper "_TYPEDEF"
+            print "#define " upper "_TYPEDEF"
+            print "typedef struct " type " " type ";"
+            print "#endif"
+          }
+        }
+      }
+    ' self=${self} hierarchy=${hierarchy_file:-/dev/null} moved=mvfile \
+      ${hierarchy_file:-/dev/null} ${header} > phfile
+    mv phfile ${header}
+
+    # the moved includes follow the includes of the .c, unless it has them.
+    if [ -s mvfile ];
+    then
+        grep -vxF -f <(grep "^#include" ${source}) mvfile > mifile
+        sed -i "$(last_leading_include ${source})r mifile" ${source}
+    fi
+}
+
+if [[ ${prune_includes} == "yes" ]];
+then
+    touch mvfile
+    prune_header_includes ${c_header} ${c_source_file}
+fi
+
+
+
+
+
+###
+### dispatch benchmark
+###
+
+# the dispatch benchmark of the class mirrors its methods and its class
+# hierarchy with bodies doing almost nothing, once as c++ classes and once as
+# c on the stub runtime of benchmarks/dispatch, so only the cost of the calls
+# is measured. all the mirrored methods take and return an int. the c side
+# does not include the converted ${self}.h, which needs the headers of the
+# project, it declares its own structs, class structs and cast macros the
+# way they are emitted above.
+function generate_dispatch_benchmark(){
+    local lang=$1
+    local chain=()
+    local ancestor=${parent}
+
+    # the ancestors, from the root class down to the parent.
+    while [[ ${ancestor} != "Object" && ${ancestor} != '' && ${#chain[@]} -lt 64 ]];
+    do
+        chain=(${ancestor} "${chain[@]}")
+        if [[ ${hierarchy_file} == '' ]];
+        then
+            break
+        fi
+        ancestor=$(awk '$1 == "class" && $2 == name { print $3; exit }' \
+            name=${ancestor} ${hierarchy_file})
+    done
+    chain+=(${self})
+
+    local class_methods=$(cat cflist 2>/dev/null)
+    local object_methods=$(cat omlist 2>/dev/null)
+    local virtual_methods=$(cat vflist pvflist 2>/dev/null)
+    local method owner class previous upper
+
+    # the methods emitted as static inline functions in ${self}.h are called
+    # inline in both benchmarks, the others are kept out of line.
+    declare -A linkage_of
+    for method in ${class_methods} ${object_methods};
+    do
+        linkage_of[$method]="BENCH_NOINLINE "
+    done
+    for method in $(sed -n "s/^static inline .*[ *]${self}_\([a-zA-Z_0-9]*\)(.*/\1/p" ilfile);
+    do
+        linkage_of[$method]="inline "
+    done
+
+    declare -A owner_of
+    for method in ${virtual_methods};
+    do
+        owner=$(virtual_owner_of ${method})
+        owner_of[$method]=${owner:-${self}}
+    done
+
+    echo "// dispatch benchmark of ${self} generated by converter.sh, the methods"
+    echo "// have the dispatch of the $([[ ${lang} == "c" ]] && echo "converted" || echo "c++") class and trivial bodies."
+    echo ""
+
+    if [[ ${lang} == "cpp" ]];
+    then
+        echo "#include \"bench.h\""
+        echo ""
+
+        previous=''
+        for class in "${chain[@]}";
+        do
+            echo "class ${class}${previous:+ : public ${previous}} {"
+            echo "  protected:"
+            echo "    int field${class};"
+            echo ""
+            echo "  public:"
+            echo "    ${class}(void) : field${class}(0) {}"
+            if [[ ${previous} == '' ]];
+            then
+                echo "    virtual ~${class}(void) {}"
+            fi
+            for method in ${virtual_methods};
+            do
+                if [[ ${owner_of[$method]} == ${class} || ${class} == ${self} ]];
+                then
+                    echo "    virtual int ${method}(int value) const;"
+                fi
+            done
+            if [[ ${class} == ${self} ]];
+            then
+                for method in ${class_methods};
+                do
+                    echo "    static int ${method}(int value);"
+                done
+                for method in ${object_methods};
+                do
+                    echo "    int ${method}(int value) const;"
+                done
+            fi
+            echo "};"
+            echo ""
+            previous=${class}
+        done
+
+        for method in ${virtual_methods};
+        do
+            if [[ ${owner_of[$method]} != ${self} ]];
+            then
+                echo "BENCH_NOINLINE int ${owner_of[$method]}::${method}(int value) const { return value; }"
+            fi
+            echo "BENCH_NOINLINE int ${self}::${method}(int value) const { return field${self} + value; }"
+        done
+        for method in ${class_methods};
+        do
+            echo "${linkage_of[$method]}int ${self}::${method}(int value) { return value + 1; }"
+        done
+        for method in ${object_methods};
+        do
+            echo "${linkage_of[$method]}int ${self}::${method}(int value) const { return field${self} + value; }"
+        done
+        echo ""
+
+        echo "static ${self} *volatile bench_obj;"
+        echo "static ${self} *volatile bench_new;"
+        echo ""
+        echo "int main(int argc, char *argv[])"
+        echo "{"
+        echo "    long long n = argc > 1 ? atoll(argv[1]) : 1000000;"
+        echo ""
+        echo "    bench_open_counter();"
+        echo "    bench_obj = new ${self}();"
+        echo ""
+        for method in ${class_methods};
+        do
+            echo "    BENCH(\"class\", \"${method}\", n, bench_sink = ${self}::${method}((int)bench_i));"
+        done
+        for method in ${object_methods};
+        do
+            echo "    BENCH(\"member\", \"${method}\", n, bench_sink = bench_obj->${method}((int)bench_i));"
+        done
+        for method in ${virtual_methods};
+        do
+            echo "    BENCH(\"virtual\", \"${method}\", n, bench_sink = bench_obj->${method}((int)bench_i));"
+        done
+        echo "    BENCH(\"new\", \"new\", n, bench_new = new ${self}(); delete bench_new);"
+        echo ""
+        echo "    return 0;"
+        echo "}"
+        return
+    fi
+
+    echo "#include \"qom_stub.h\""
+    echo "#include \"bench.h\""
+    echo ""
+
+    previous=''
+    for class in "${chain[@]}";
+    do
+        upper=$(echo ${class} | tr 'a-z' 'A-Z')
+        echo "#define TYPE_${upper} \"$(echo ${class} | tr 'A-Z' 'a-z')\""
+        echo ""
+        echo "typedef struct ${class} ${class};"
+        echo "typedef struct ${class}Class ${class}Class;"
+        echo ""
+        echo "struct ${class} {"
+        echo "    ${previous:-Object} parent;"
+        echo "    int field${class};"
+        echo "};"
+        echo ""
+        echo "struct ${class}Class {"
+        echo "    ${previous:-Object}Class parent_class;"
+        for method in ${virtual_methods};
+        do
+            if [[ ${owner_of[$method]} == ${class} ]];
+            then
+                echo "    int (*${method})(const void *obj, int value);"
+            fi
+        done
+        echo "};"
+        echo ""
+        echo "#define ${upper}_GET_CLASS(obj) \\"
+        echo "        OBJECT_GET_CLASS(${class}Class, obj, TYPE_${upper})"
+        echo ""
+        echo "#define ${upper}_CLASS(klass) \\"
+        echo "        OBJECT_CLASS_CHECK(${class}Class, klass, TYPE_${upper})"
+        echo ""
+        echo "#define ${upper}(obj) \\"
+        echo "        OBJECT_CHECK(${class}, obj, TYPE_${upper})"
+        echo ""
+        previous=${class}
+    done
+
+    for method in ${class_methods};
+    do
+        echo "$([[ ${linkage_of[$method]} == "inline " ]] && echo "static ")${linkage_of[$method]}int ${self}_${method}(int value) { return value + 1; }"
+    done
+    for method in ${object_methods};
+    do
+        echo "$([[ ${linkage_of[$method]} == "inline " ]] && echo "static ")${linkage_of[$method]}int ${self}_${method}(const ${self} *This, int value) { return This->field${self} + value; }"
+    done
+    for method in ${virtual_methods};
+    do
+        echo "static BENCH_NOINLINE int ${method}(const void *obj, int value) { return ${uppercase_self}(obj)->field${self} + value; }"
+    done
+    echo ""
+
+    echo "BENCH_NOINLINE ${self}* ${self}_new(void)"
+    echo "{"
+    echo "    return (${self}*)object_new(TYPE_${uppercase_self});"
+    echo "}"
+    echo ""
+    echo "static void class_init(ObjectClass *oc, void *data)"
+    echo "{"
+    echo "    (void)data;"
+    for method in ${virtual_methods};
+    do
+        echo "    $(echo ${owner_of[$method]} | tr 'a-z' 'A-Z')_CLASS(oc)->${method} = ${method};"
+    done
+    echo "}"
+    echo ""
+
+    previous=''
+    for class in "${chain[@]}";
+    do
+        upper=$(echo ${class} | tr 'a-z' 'A-Z')
+        echo "static const TypeInfo ${class}_type_info = {"
+        echo "    .name = TYPE_${upper},"
+        echo "    .parent = TYPE_$(echo ${previous:-Object} | tr 'a-z' 'A-Z'),"
+        echo "    .instance_size = sizeof(${class}),"
+        echo "    .abstract = false,"
+        echo "    .class_size = sizeof(${class}Class),"
+        if [[ ${class} == ${self} ]];
+        then
+            echo "    .class_init = class_init,"
+        fi
+        echo "};"
+        echo ""
+        previous=${class}
+    done
+
+    echo "static ${self} *volatile bench_obj;"
+    echo "static ${self} *volatile bench_new;"
+    echo ""
+    echo "int main(int argc, char *argv[])"
+    echo "{"
+    echo "    long long n = argc > 1 ? atoll(argv[1]) : 1000000;"
+    echo ""
+    for class in "${chain[@]}";
+    do
+        echo "    type_register_static(&${class}_type_info);"
+    done
+    echo "    bench_open_counter();"
+    echo "    bench_obj = ${self}_new();"
+    echo ""
+    for method in ${class_methods};
+    do
+        echo "    BENCH(\"class\", \"${method}\", n, bench_sink = ${self}_${method}((int)bench_i));"
+    done
+    for method in ${object_methods};
+    do
+        echo "    BENCH(\"member\", \"${method}\", n, bench_sink = ${self}_${method}(bench_obj, (int)bench_i));"
+    done
+    for method in ${virtual_methods};
+    do
+        echo "    BENCH(\"virtual\", \"${method}\", n, bench_sink = $(echo ${owner_of[$method]} | tr 'a-z' 'A-Z')_GET_CLASS(bench_obj)->${method}(bench_obj, (int)bench_i));"
+    done
+    echo "    BENCH(\"new\", \"new\", n, bench_new = ${self}_new(); object_unref(OBJECT(bench_new)));"
+    echo ""
+    echo "    return 0;"
+    echo "}"
+}
+
+if [[ ${dispatch_benchmark} == "yes" ]];
+then
+    generate_dispatch_benchmark cpp > ${self}_bench.cpp
+    generate_dispatch_benchmark c > ${self}_bench.c
+fi
+
+if [[ ${profile} == "yes" ]];
+then
+    profile_phase ""
+    print_profile_json \
+        class_methods=$(cat cflist 2>/dev/null | wc -l) \
+        object_methods=$(cat omlist 2>/dev/null | wc -l) \
+        virtual_methods=$(cat vflist 2>/dev/null | wc -l) \
+        pure_virtual_methods=$(cat pvflist 2>/dev/null | wc -l) \
+        inline_methods=$(grep -c "^static inline" ilfile) \
+        body_index_entries=$(wc -l < fbifile) \
+        body_index_lookups=${body_index_lookups} \
+        sed_inplace_rewrites=${sed_inplace_num} > ${self}.profile.json
+fi
+
+if [[ ${layout} == "yes" ]];
+then
+    cat ${self}.layout.txt
+fi
+
 echo "conversion is done."
 
 rm -f *file *list range